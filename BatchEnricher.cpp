@@ -0,0 +1,389 @@
+#include "BatchEnricher.h"
+#include "MovieJson.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+// JSON alias
+using json = nlohmann::json;
+
+namespace {
+
+std::string lowerCase(std::string text) {
+    for (char &c: text) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+bool isImdbID(const std::string &text) {
+    return ParseImdbNumber(text) >= 0;
+}
+
+// The candidate of a search that best matches the requested title and year; candidates are in popularity order.
+// Scores 2 for the requested year plus 1 for the exact title; nullptr if no candidate reaches minScore.
+const Movie *bestMatch(const std::vector<Movie> &candidates, const std::string &title, int year, int minScore) {
+    const Movie *best = nullptr;
+    int bestScore = -1;
+    std::string wanted = lowerCase(title);
+    for (const Movie &movie: candidates) {
+        int score = (year != 0 && movie.releaseYear == year ? 2 : 0) + (lowerCase(movie.title) == wanted ? 1 : 0);
+        if (score > bestScore) {
+            best = &movie;
+            bestScore = score;
+        }
+    }
+    return bestScore >= minScore ? best : nullptr;
+}
+
+double millis(uint64_t micros) {
+    return static_cast<double>(micros) / 1000.0;
+}
+
+}// namespace
+
+
+/**
+ * @brief Adds one latency sample.
+ *
+ * @param micros The latency in microseconds.
+ */
+void BatchEnricher::LatencyHistogram::add(uint64_t micros) {
+    size_t bucket = micros;
+    if (micros >= 4) {
+        // Top three bits: the power of two and which quarter of it
+        size_t exponent = std::bit_width(micros) - 1;
+        bucket = exponent * 4 + ((micros >> (exponent - 2)) & 3);
+    }
+    counts[std::min(bucket, kBuckets - 1)]++;
+    samples++;
+    totalMicros += micros;
+    maxMicros = std::max(maxMicros, micros);
+}
+
+/**
+ * @brief Returns an upper bound of a latency percentile, accurate to a quarter of a power of two.
+ *
+ * @param fraction The percentile as a fraction, e.g. 0.95.
+ * @return The latency in microseconds, 0 if there are no samples.
+ */
+uint64_t BatchEnricher::LatencyHistogram::percentile(double fraction) const {
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(samples) + 0.5);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+        seen += counts[bucket];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            // The start of the next bucket
+            size_t next = bucket + 1;
+            uint64_t bound = next < 8 ? std::min<uint64_t>(next, 4) : (uint64_t(4 + next % 4) << (next / 4 - 2));
+            return std::min(bound, maxMicros);
+        }
+    }
+    return maxMicros;
+}
+
+/**
+ * @brief Prints the throughput and the latency of each stage.
+ *
+ * @param out The stream to print to.
+ */
+void BatchEnricher::Report::print(std::ostream &out) const {
+    out << "Enriched " << lines << " lines in " << std::fixed << std::setprecision(2) << seconds << " s ("
+        << (seconds > 0.0 ? static_cast<double>(lines) / seconds : 0.0) << " lookups/sec): " << resolved << " resolved, "
+        << lines - resolved << " failed, " << coalesced << " coalesced, " << catalogHits << " from the local catalog"
+        << std::endl;
+    out << std::left << std::setw(9) << "Stage" << std::right << std::setw(8) << "count" << std::setw(11) << "mean ms"
+        << std::setw(11) << "p50 ms" << std::setw(11) << "p95 ms" << std::setw(11) << "p99 ms" << std::setw(11)
+        << "max ms" << std::endl;
+    const std::pair<const char *, const LatencyHistogram *> stages[] = {
+            {"search", &search}, {"details", &details}, {"poster", &poster}, {"total", &total}};
+    for (const auto &[name, stage]: stages) {
+        double mean = stage->samples ? millis(stage->totalMicros) / static_cast<double>(stage->samples) : 0.0;
+        out << std::left << std::setw(9) << name << std::right << std::setw(8) << stage->samples << std::setw(11) << mean
+            << std::setw(11) << millis(stage->percentile(0.50)) << std::setw(11) << millis(stage->percentile(0.95))
+            << std::setw(11) << millis(stage->percentile(0.99)) << std::setw(11) << millis(stage->maxMicros) << std::endl;
+    }
+    out << std::defaultfloat;
+}
+
+/**
+ * @brief Creates an enricher; nothing is read until run().
+ *
+ * @param api Resolves IMDb IDs and searches titles, through its response and poster caches.
+ * @param scheduler Runs the lookups.
+ * @param catalog Local catalog searched before OMDb, or nullptr to always ask OMDb.
+ * @param options Concurrency and poster settings.
+ */
+BatchEnricher::BatchEnricher(OMDbApi &api, TaskScheduler &scheduler, const LocalCatalog *catalog, const Options &options)
+    : api(api), scheduler(scheduler), catalog(catalog), options(options) {
+    this->options.maxInFlight = std::max<size_t>(this->options.maxInFlight, 1);
+}
+
+/**
+ * @brief Resolves every line of the input and writes one JSON line per input line.
+ *
+ * Results are written in input order as soon as every earlier line is done.
+ * At most Options::maxInFlight lines are resolved or waiting to be written at
+ * any time. Stops early once cancel() is called.
+ *
+ * @param input The CSV or JSON Lines input.
+ * @param output Receives the JSON Lines output.
+ * @param report Receives the counters and latencies.
+ * @return true if the whole input was processed and written.
+ */
+bool BatchEnricher::run(std::istream &input, std::ostream &output, Report &report) {
+    this->report = &report;
+    auto start = std::chrono::steady_clock::now();
+    std::deque<Pending> window;// Lines in input order, being resolved or waiting to be written
+
+    // Write the oldest line once its lookup is done
+    auto writeFront = [&]() {
+        Pending &front = window.front();
+        const Result &result = front.result.get();
+        writeResult(output, front, result);
+        auto shared = inFlight.find(requestKey(front.request));
+        if (shared != inFlight.end() && --shared->second.second == 0) {
+            inFlight.erase(shared);
+        }
+        window.pop_front();
+    };
+
+    std::string line;
+    bool firstLine = true;
+    while (!token.cancelled() && std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.find_first_not_of(" \t") == std::string::npos) {
+            continue;
+        }
+
+        if (firstLine) {
+            firstLine = false;
+            if (readFormat(line)) {
+                continue;// CSV header
+            }
+        }
+        Pending pending;
+        bool parsed = parseLine(line, pending.request);
+        {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            report.lines++;
+        }
+        if (!parsed) {
+            std::promise<Result> invalid;
+            invalid.set_value(Result{std::nullopt, "No title or IMDb ID on this line."});
+            pending.result = invalid.get_future().share();
+        } else if (auto shared = inFlight.find(requestKey(pending.request)); shared != inFlight.end()) {
+            // The same movie is being looked up for an earlier line
+            pending.result = shared->second.first;
+            shared->second.second++;
+            std::lock_guard<std::mutex> lock(reportMutex);
+            report.coalesced++;
+        } else {
+            auto queued = std::chrono::steady_clock::now();
+            pending.result = scheduler.submit(TaskPriority::Current, [this, request = pending.request, queued]() {
+                                          return resolve(request, queued);
+                                      }).share();
+            inFlight.emplace(requestKey(pending.request), std::make_pair(pending.result, size_t(1)));
+        }
+        window.push_back(std::move(pending));
+        while (window.size() >= options.maxInFlight) {
+            writeFront();
+        }
+    }
+    while (!window.empty()) {
+        writeFront();
+    }
+    output.flush();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    this->report = nullptr;
+    return !token.cancelled() && !input.bad() && output.good();
+}
+
+// Tell JSON Lines from CSV by the first line, and read the CSV header if there is one
+bool BatchEnricher::readFormat(const std::string &line) {
+    jsonLines = line[line.find_first_not_of(" \t")] == '{';
+    if (jsonLines) {
+        return false;
+    }
+    // A header names the columns, e.g. IMDb's list exports: "Position,Const,...,Title,...,Year,..."
+    std::vector<std::string> fields = splitCsv(line);
+    int title = -1, id = -1, year = -1;
+    for (int column = 0; column < static_cast<int>(fields.size()); column++) {
+        std::string name = lowerCase(fields[column]);
+        if (name == "title") title = column;
+        else if (name == "imdbid" || name == "imdb_id" || name == "const" || name == "id") id = column;
+        else if (name == "year") year = column;
+    }
+    if (title < 0 && id < 0) {
+        return false;// No header, the first column is a title or IMDb ID and the second the year
+    }
+    titleColumn = title;
+    idColumn = id;
+    yearColumn = year;
+    return true;
+}
+
+// Read the title, IMDb ID and year of one line
+bool BatchEnricher::parseLine(const std::string &line, Request &request) {
+    request.input = line;
+    if (jsonLines) {
+        json object = json::parse(line, nullptr, false);
+        if (!object.is_object()) {
+            return false;
+        }
+        for (const char *key: {"imdbID", "imdbId", "id"}) {
+            if (object.contains(key) && object[key].is_string()) {
+                request.imdbID = object[key].get<std::string>();
+                break;
+            }
+        }
+        for (const char *key: {"title", "Title"}) {
+            if (object.contains(key) && object[key].is_string()) {
+                request.title = object[key].get<std::string>();
+                break;
+            }
+        }
+        for (const char *key: {"year", "Year"}) {
+            if (object.contains(key)) {
+                request.year = object[key].is_number_integer() ? object[key].get<int>()
+                               : object[key].is_string()       ? ParseReleaseYear(object[key].get<std::string>())
+                                                               : 0;
+                break;
+            }
+        }
+        return isImdbID(request.imdbID) || !request.title.empty();
+    }
+
+    std::vector<std::string> fields = splitCsv(line);
+    auto field = [&fields](int column) { return column >= 0 && column < static_cast<int>(fields.size()) ? fields[column] : std::string(); };
+    request.imdbID = field(idColumn);
+    request.title = field(titleColumn);
+    request.year = ParseReleaseYear(field(yearColumn));
+    if (request.imdbID.empty() && isImdbID(request.title)) {
+        request.imdbID = std::move(request.title);// A headerless list of IMDb IDs
+        request.title.clear();
+    }
+    return isImdbID(request.imdbID) || !request.title.empty();
+}
+
+// Look up one movie, its details and its poster; runs on the scheduler
+BatchEnricher::Result BatchEnricher::resolve(const Request &request, std::chrono::steady_clock::time_point queued) {
+    Result result;
+    if (token.cancelled()) {
+        result.error = "Cancelled.";
+        return result;
+    }
+    if (isImdbID(request.imdbID)) {
+        auto start = std::chrono::steady_clock::now();
+        result.movie = api.lookupMovie(request.imdbID, token);
+        record(&Report::details, start);
+    } else {
+        result.movie = resolveTitle(request);
+    }
+    if (!result.movie) {
+        result.error = isImdbID(request.imdbID) ? "Movie not found." : "No movie matches the title.";
+    } else if (options.posters && !token.cancelled()) {
+        auto start = std::chrono::steady_clock::now();
+        result.movie->posterPath = api.fetchPoster(result.movie->imdbID, token);
+        record(&Report::poster, start);
+    }
+    record(&Report::total, queued);
+    return result;
+}
+
+// Find the movie a title refers to: in the local catalog, which has the details too, or with an OMDb search.
+// A catalog match must have the requested year, or the exact title if no year was given; typo-corrected
+// and substring hits alone are not trusted. With a year, an OMDb candidate must have that year too.
+std::optional<Movie> BatchEnricher::resolveTitle(const Request &request) {
+    auto start = std::chrono::steady_clock::now();
+    if (catalog) {
+        std::vector<Movie> found = catalog->search(request.title, 20, false);
+        if (found.empty()) {
+            found = catalog->searchFuzzy(request.title, 20);
+        }
+        if (const Movie *match = bestMatch(found, request.title, request.year, request.year != 0 ? 2 : 1)) {
+            record(&Report::search, start);
+            std::lock_guard<std::mutex> lock(reportMutex);
+            report->catalogHits++;
+            return *match;
+        }
+    }
+    std::optional<OMDbApi::SearchPage> page = api.fetchSearchPage(request.title, 1, token);
+    record(&Report::search, start);
+    const Movie *match = page ? bestMatch(page->movies, request.title, request.year, request.year != 0 ? 2 : 0) : nullptr;
+    if (!match) {
+        return std::nullopt;
+    }
+    start = std::chrono::steady_clock::now();
+    std::optional<Movie> detailed = api.lookupMovie(match->imdbID, token);
+    record(&Report::details, start);
+    return detailed ? detailed : *match;
+}
+
+void BatchEnricher::writeResult(std::ostream &output, const Pending &pending, const Result &result) {
+    json record;
+    if (result.movie) {
+        record = MovieToJson(*result.movie);
+        record["Response"] = "True";
+        if (options.posters) {
+            record["posterPath"] = result.movie->posterPath;
+        }
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report->resolved++;
+    } else {
+        record = {{"Response", "False"}, {"Error", result.error}};
+    }
+    record["input"] = pending.request.input;
+    output << record.dump() << '\n';
+}
+
+// Add the time since start to one stage's latency histogram
+void BatchEnricher::record(LatencyHistogram Report::*stage, std::chrono::steady_clock::time_point start) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(reportMutex);
+    (report->*stage).add(static_cast<uint64_t>(micros));
+}
+
+// Lines with the same key are resolved by one lookup
+std::string BatchEnricher::requestKey(const Request &request) {
+    if (isImdbID(request.imdbID)) {
+        return request.imdbID;
+    }
+    return lowerCase(request.title) + '\n' + std::to_string(request.year);
+}
+
+// Split one CSV row; fields may be quoted, with "" for a quote inside
+std::vector<std::string> BatchEnricher::splitCsv(const std::string &line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                i++;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.back() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else {
+            fields.back() += c;
+        }
+    }
+    for (std::string &field: fields) {
+        size_t first = field.find_first_not_of(" \t");
+        size_t last = field.find_last_not_of(" \t");
+        field = first == std::string::npos ? std::string() : field.substr(first, last - first + 1);
+    }
+    return fields;
+}
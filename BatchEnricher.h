@@ -0,0 +1,128 @@
+#ifndef BATCH_ENRICHER_H
+#define BATCH_ENRICHER_H
+
+#include "CancellationToken.h"
+#include "LocalCatalog.h"
+#include "OMDbApi.h"
+#include "TaskScheduler.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * @class BatchEnricher
+ * @brief Resolves a list of titles or IMDb IDs to full movie records, many at a time.
+ *
+ * The input is CSV or JSON Lines (detected from the first line):
+ * - CSV: one title or IMDb ID per row, optionally followed by a year. A header
+ *   row naming the "title", "imdbID" and "year" columns is recognized.
+ * - JSON Lines: one object per line with "imdbID" and/or "title" and "year".
+ *
+ * Every input line becomes one JSON line in the output, in input order: the
+ * movie in MovieToJson() form plus "input" and "posterPath", or "Error" if
+ * it could not be resolved. Titles are looked up in the local catalog first,
+ * then with an OMDb search; the details and the poster come from the
+ * OMDbApi and its caches.
+ *
+ * Up to maxInFlight lines are resolved concurrently on the task scheduler
+ * while the output is written. Lines are read only as earlier ones finish,
+ * so memory stays constant however long the input is. Duplicate lines in
+ * flight at the same time share one lookup.
+ */
+class BatchEnricher {
+public:
+    struct Options {
+        size_t maxInFlight = 64;// Lines being resolved at the same time
+        bool posters = true;    // Download the posters into the poster cache
+    };
+
+    // Latencies in microseconds, bucketed on a log scale (four buckets per power of two)
+    struct LatencyHistogram {
+        static constexpr size_t kBuckets = 128;
+        std::array<uint64_t, kBuckets> counts{};
+        uint64_t samples = 0;
+        uint64_t totalMicros = 0;
+        uint64_t maxMicros = 0;
+
+        void add(uint64_t micros);
+        uint64_t percentile(double fraction) const;
+    };
+
+    struct Report {
+        uint64_t lines = 0;     // Input lines, including unresolved ones
+        uint64_t resolved = 0;  // Lines with a movie in the output
+        uint64_t coalesced = 0; // Lines answered by a lookup already in flight
+        uint64_t catalogHits = 0;// Titles resolved by the local catalog
+        double seconds = 0.0;
+        LatencyHistogram search;  // Title -> IMDb ID, catalog or OMDb search
+        LatencyHistogram details; // IMDb ID -> details
+        LatencyHistogram poster;  // Poster download or cache hit
+        LatencyHistogram total;   // Whole lookup, from being queued to done
+
+        void print(std::ostream &out) const;
+    };
+
+    BatchEnricher(OMDbApi &api, TaskScheduler &scheduler, const LocalCatalog *catalog, const Options &options);
+
+    BatchEnricher(const BatchEnricher &) = delete;
+    BatchEnricher &operator=(const BatchEnricher &) = delete;
+
+    bool run(std::istream &input, std::ostream &output, Report &report);
+    void cancel() { token.cancel(); }
+
+private:
+    // One line of the input
+    struct Request {
+        std::string input;// The line as read, echoed into the output
+        std::string imdbID;
+        std::string title;
+        int year = 0;     // 0 if not given
+    };
+
+    struct Result {
+        std::optional<Movie> movie;
+        std::string error;
+    };
+
+    struct Pending {
+        Request request;
+        std::shared_future<Result> result;
+    };
+
+    bool readFormat(const std::string &line);
+    bool parseLine(const std::string &line, Request &request);
+    Result resolve(const Request &request, std::chrono::steady_clock::time_point queued);
+    std::optional<Movie> resolveTitle(const Request &request);
+    void writeResult(std::ostream &output, const Pending &pending, const Result &result);
+    void record(LatencyHistogram Report::*stage, std::chrono::steady_clock::time_point start);
+    static std::string requestKey(const Request &request);
+    static std::vector<std::string> splitCsv(const std::string &line);
+
+    OMDbApi &api;
+    TaskScheduler &scheduler;
+    const LocalCatalog *catalog;// Searched before OMDb, nullptr if not built
+    Options options;
+    CancellationToken token;
+
+    // Input format, set from the first line
+    bool jsonLines = false;
+    int titleColumn = 0;
+    int idColumn = -1;
+    int yearColumn = 1;
+
+    std::unordered_map<std::string, std::pair<std::shared_future<Result>, size_t>> inFlight;// Lookup key -> result, users
+
+    std::mutex reportMutex;// Guards report, updated by the lookup tasks
+    Report *report = nullptr;
+};
+
+#endif // BATCH_ENRICHER_H
@@ -0,0 +1,26 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <memory>
+
+
+/**
+ * @class CancellationToken
+ * @brief A shared flag telling in-flight work that its result is no longer wanted.
+ *
+ * Copies share the same flag, so the GUI can keep one copy and cancel the
+ * requests and queued tasks that hold the others.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag->store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+#endif // CANCELLATION_TOKEN_H
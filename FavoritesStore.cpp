@@ -0,0 +1,464 @@
+#include "FavoritesStore.h"
+#include "PosterCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Binary journal: magic and version, then records of {u8 type, u32 payload size, payload}
+static const char kMagic[4] = {'F', 'A', 'V', 'J'};
+static const uint32_t kVersion = 2;                // Version 1 was the tab-separated text journal
+static const char *kTextJournalHeader = "# favorites-journal v1";
+static const char *kTextJournalName = "favorites.journal";// Older versions' files, next to the journal
+static const char *kLegacyName = "favorites.txt";
+static const char *kKeptPostersName = "favorite-posters";// Copies of the favorites' posters, next to the journal
+static const char kAddRecord = 'A';   // Payload: key, then the movie
+static const char kRemoveRecord = 'R';// Payload: key
+static const size_t kMinCompactRecords = 64;// Never compact journals shorter than this
+
+// Strings are stored as a u32 length followed by the bytes
+static void putString(std::string &out, const std::string &value) {
+    uint32_t size = static_cast<uint32_t>(value.size());
+    out.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.append(value);
+}
+
+template<typename T>
+static void putValue(std::string &out, T value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// Bounds-checked reader over one record payload
+struct PayloadReader {
+    const char *data;
+    size_t size;
+    size_t offset = 0;
+
+    bool getString(std::string &value) {
+        uint32_t length;
+        if (!getValue(length) || size - offset < length) return false;
+        value.assign(data + offset, length);
+        offset += length;
+        return true;
+    }
+
+    template<typename T>
+    bool getValue(T &value) {
+        if (size - offset < sizeof(T)) return false;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+};
+
+static std::string encodeMovie(const std::string &key, const Movie &movie) {
+    std::string payload;
+    putString(payload, key);
+    putString(payload, movie.imdbID);
+    putString(payload, movie.title);
+    putString(payload, movie.year);
+    putString(payload, movie.genre);
+    putString(payload, movie.imdbRating);
+    putString(payload, movie.posterUrl);
+    putString(payload, movie.posterPath);
+    putValue<int32_t>(payload, movie.releaseYear);
+    putValue<float>(payload, movie.rating);
+    return payload;
+}
+
+static bool decodeMovie(PayloadReader &reader, std::string &key, Movie &movie) {
+    int32_t releaseYear;
+    float rating;
+    if (!reader.getString(key) || !reader.getString(movie.imdbID) || !reader.getString(movie.title) ||
+        !reader.getString(movie.year) || !reader.getString(movie.genre) || !reader.getString(movie.imdbRating) ||
+        !reader.getString(movie.posterUrl) || !reader.getString(movie.posterPath) ||
+        !reader.getValue(releaseYear) || !reader.getValue(rating)) {
+        return false;
+    }
+    movie.releaseYear = releaseYear;
+    movie.rating = rating;
+    return true;
+}
+
+// Write the file's buffered data through to the disk
+static void syncFile(std::FILE *file) {
+    std::fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+
+/**
+ * @brief Constructs the store; the journal is read on first use.
+ *
+ * @param journalPath Path of the append-only journal.
+ * @param posterDirectory Directory of the poster cache the posters are looked up in.
+ * @param syncInterval Longest time an appended record may wait for fsync.
+ */
+FavoritesStore::FavoritesStore(const std::string &journalPath, const std::string &posterDirectory, std::chrono::milliseconds syncInterval)
+    : journalPath(journalPath), posterDirectory(posterDirectory),
+      keptPosterDirectory((fs::path(journalPath).parent_path() / kKeptPostersName).string()), syncInterval(syncInterval) {}
+
+/**
+ * @brief Syncs the pending journal records and closes the journal.
+ */
+FavoritesStore::~FavoritesStore() {
+    if (journal) {
+        sync(true);
+        std::fclose(journal);
+    }
+}
+
+/**
+ * @brief Adds a movie to the favorites.
+ *
+ * @param movie The movie to add, with whatever details are known.
+ * @return true if it was added, false if it already was a favorite.
+ */
+bool FavoritesStore::add(const Movie &movie) {
+    ensureLoaded();
+    std::string key = keyOf(movie);
+    if (contains(key)) {
+        return false;
+    }
+    Movie favorite = movie;
+    resolvePoster(favorite);
+    append(kAddRecord, encodeMovie(key, favorite));
+    insert(std::move(favorite));
+    return true;
+}
+
+/**
+ * @brief Removes a movie from the favorites.
+ *
+ * @param key The key of the movie, see keyOf().
+ * @return true if it was removed, false if it was not a favorite.
+ */
+bool FavoritesStore::remove(const std::string &key) {
+    ensureLoaded();
+    if (!contains(key)) {
+        return false;
+    }
+    const Movie &movie = favorites[indexByKey[key]];
+    if (!movie.imdbID.empty()) {
+        // Drop the kept poster copy and the thumbnail the GUI made of it
+        std::error_code ec;
+        fs::path kept = PosterCache::pathIn(keptPosterDirectory, movie.imdbID);
+        fs::remove(kept, ec);
+        fs::remove(kept.replace_extension(".thumb"), ec);
+    }
+    erase(key);
+    std::string payload;
+    putString(payload, key);
+    append(kRemoveRecord, payload);
+    if (journalRecords >= kMinCompactRecords && journalRecords > 2 * favorites.size()) {
+        compact();
+    }
+    return true;
+}
+
+/**
+ * @brief Returns true if the movie with the given key is a favorite.
+ */
+bool FavoritesStore::contains(const std::string &key) {
+    ensureLoaded();
+    return indexByKey.count(key) != 0;
+}
+
+/**
+ * @brief Returns the favorites in display order.
+ */
+const std::vector<Movie> &FavoritesStore::movies() {
+    ensureLoaded();
+    return favorites;
+}
+
+/**
+ * @brief Forces appended journal records to disk once they have waited syncInterval.
+ *
+ * Called once per frame; batching the fsync calls keeps rapid clicks from
+ * stalling the GUI thread on disk writes.
+ *
+ * @param force Sync now regardless of the interval.
+ */
+void FavoritesStore::sync(bool force) {
+    if (!unsynced || !journal) {
+        return;
+    }
+    if (!force && std::chrono::steady_clock::now() - firstUnsynced < syncInterval) {
+        return;
+    }
+    syncFile(journal);
+    unsynced = false;
+}
+
+/**
+ * @brief Returns the key of a movie: its IMDb ID, or its title and year for favorites imported from favorites.txt.
+ */
+std::string FavoritesStore::keyOf(const Movie &movie) {
+    if (!movie.imdbID.empty()) {
+        return movie.imdbID;
+    }
+    return "title:" + movie.title + "|" + movie.year;
+}
+
+// Read the journal, or import the favorites of older versions, the first time the favorites are needed
+void FavoritesStore::ensureLoaded() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+    std::error_code ec;
+    if (!fs::exists(journalPath, ec)) {
+        // First run of this version: import the favorites saved by older ones
+        fs::path directory = fs::path(journalPath).parent_path();
+        if (fs::exists(directory / kTextJournalName, ec)) {
+            importTextJournal((directory / kTextJournalName).string());
+        } else {
+            importLegacy((directory / kLegacyName).string());
+        }
+    } else if (!load()) {
+        // Damaged or written by a newer version: keep it for the user instead of overwriting it
+        std::string asidePath = journalPath + ".bad";
+        for (int n = 1; fs::exists(asidePath, ec); n++) {
+            asidePath = journalPath + ".bad" + std::to_string(n);
+        }
+        fs::rename(journalPath, asidePath, ec);
+        if (ec) {
+            std::cerr << "ERROR: Could not move favorites journal " << journalPath << " aside: " << ec.message()
+                      << "; favorites will not be saved" << std::endl;
+            return;
+        }
+        std::cerr << "Warning: Moved favorites journal " << journalPath << " to " << asidePath << std::endl;
+    }
+    for (Movie &movie: favorites) {
+        resolvePoster(movie);
+    }
+    compact();// Start from a journal holding only live favorites, then append to it
+}
+
+// Replay the binary journal; returns false if it cannot be read or has an unknown format or version
+bool FavoritesStore::load() {
+    std::ifstream in(journalPath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    uint32_t version = 0;
+    if (data.size() < sizeof(kMagic) + sizeof(version) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "Warning: Ignoring unknown favorites journal " << journalPath << std::endl;
+        return false;
+    }
+    std::memcpy(&version, data.data() + sizeof(kMagic), sizeof(version));
+    if (version != kVersion) {
+        std::cerr << "Warning: Ignoring favorites journal version " << version << " in " << journalPath << std::endl;
+        return false;
+    }
+
+    size_t offset = sizeof(kMagic) + sizeof(version);
+    while (data.size() - offset >= 1 + sizeof(uint32_t)) {
+        char type = data[offset];
+        uint32_t payloadSize;
+        std::memcpy(&payloadSize, data.data() + offset + 1, sizeof(payloadSize));
+        offset += 1 + sizeof(payloadSize);
+        if (data.size() - offset < payloadSize) {
+            break;// Record cut short by a crash
+        }
+        PayloadReader reader{data.data() + offset, payloadSize};
+        offset += payloadSize;
+
+        std::string key;
+        Movie movie;
+        if (type == kAddRecord && decodeMovie(reader, key, movie)) {
+            if (!indexByKey.count(key)) {
+                insert(std::move(movie));
+            }
+        } else if (type == kRemoveRecord && reader.getString(key)) {
+            if (indexByKey.count(key)) {
+                erase(key);
+            }
+        }
+        // Records of unknown types are skipped
+    }
+    return true;
+}
+
+// Read the tab-separated journal of version 1: "A key title year" adds, "R key" removes
+void FavoritesStore::importTextJournal(const std::string &path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!std::getline(in, line) || line != kTextJournalHeader) {
+        return;
+    }
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab - start));
+            if (tab == std::string::npos) break;
+            start = tab + 1;
+        }
+
+        if (fields[0] == "A" && fields.size() >= 4 && !indexByKey.count(fields[1])) {
+            Movie movie;
+            movie.imdbID = fields[1].rfind("title:", 0) == 0 ? "" : fields[1];
+            movie.title = fields[2];
+            movie.year = fields[3];
+            insert(std::move(movie));
+        } else if (fields[0] == "R" && fields.size() >= 2 && indexByKey.count(fields[1])) {
+            erase(fields[1]);
+        }
+    }
+    std::cout << "Imported " << favorites.size() << " favorites from " << path << std::endl;
+}
+
+// Read the "title,year" file written by the first versions
+void FavoritesStore::importLegacy(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        return;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t commaPos = line.rfind(',');// The year never contains a comma, the title may
+        if (commaPos == std::string::npos) {
+            continue;
+        }
+        Movie movie;
+        movie.title = line.substr(0, commaPos);
+        movie.year = line.substr(commaPos + 1);
+        if (!indexByKey.count(keyOf(movie))) {
+            insert(std::move(movie));
+        }
+    }
+    std::cout << "Imported " << favorites.size() << " favorites from " << path << std::endl;
+}
+
+// Point the movie at its own copy of its poster, copying it out of the poster cache if needed; the
+// cache evicts posters by last access and never sees the favorites view reading them
+void FavoritesStore::resolvePoster(Movie &movie) const {
+    std::error_code ec;
+    if (movie.imdbID.empty()) {
+        if (!movie.posterPath.empty() && !fs::exists(movie.posterPath, ec)) {
+            movie.posterPath.clear();
+        }
+        return;
+    }
+    std::string kept = PosterCache::pathIn(keptPosterDirectory, movie.imdbID);
+    if (fs::exists(kept, ec)) {
+        movie.posterPath = kept;
+        return;
+    }
+    std::string source = movie.posterPath;
+    if (source.empty() || !fs::exists(source, ec)) {
+        source = PosterCache::pathIn(posterDirectory, movie.imdbID);
+    }
+    if (!fs::exists(source, ec)) {
+        movie.posterPath.clear();
+        return;
+    }
+    // Copy to a temporary name and rename, so a crash never leaves a truncated poster behind
+    std::string tempPath = kept + ".part";
+    fs::create_directories(keptPosterDirectory, ec);
+    if (!ec) {
+        fs::copy_file(source, tempPath, fs::copy_options::overwrite_existing, ec);
+    }
+    if (!ec) {
+        fs::rename(tempPath, kept, ec);
+    }
+    if (ec) {
+        std::cerr << "ERROR: Could not keep the poster of favorite " << movie.title << " in " << kept << ": "
+                  << ec.message() << std::endl;
+        fs::remove(tempPath, ec);
+        movie.posterPath = source;// Served from the poster cache until it is evicted
+        return;
+    }
+    movie.posterPath = kept;
+}
+
+void FavoritesStore::insert(Movie movie) {
+    indexByKey[keyOf(movie)] = favorites.size();
+    favorites.push_back(std::move(movie));
+}
+
+// O(1) removal: move the last favorite into the hole
+void FavoritesStore::erase(const std::string &key) {
+    auto it = indexByKey.find(key);
+    size_t position = it->second;
+    indexByKey.erase(it);
+    if (position != favorites.size() - 1) {
+        favorites[position] = std::move(favorites.back());
+        indexByKey[keyOf(favorites[position])] = position;
+    }
+    favorites.pop_back();
+}
+
+void FavoritesStore::append(char type, const std::string &payload) {
+    if (!journal) {
+        return;
+    }
+    std::string record(1, type);
+    putValue<uint32_t>(record, static_cast<uint32_t>(payload.size()));
+    record += payload;
+    if (std::fwrite(record.data(), 1, record.size(), journal) != record.size() || std::fflush(journal) != 0) {
+        std::cerr << "ERROR: Could not write favorites journal " << journalPath << std::endl;
+        return;
+    }
+    journalRecords++;
+    if (!unsynced) {
+        unsynced = true;
+        firstUnsynced = std::chrono::steady_clock::now();
+    }
+}
+
+// Rewrite the journal with one add record per live favorite and reopen it for appending
+void FavoritesStore::compact() {
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+    std::string contents(kMagic, sizeof(kMagic));
+    putValue<uint32_t>(contents, kVersion);
+    for (const Movie &movie: favorites) {
+        std::string payload = encodeMovie(keyOf(movie), movie);
+        contents += kAddRecord;
+        putValue<uint32_t>(contents, static_cast<uint32_t>(payload.size()));
+        contents += payload;
+    }
+
+    std::string tempPath = journalPath + ".part";
+    std::FILE *out = std::fopen(tempPath.c_str(), "wb");
+    bool written = out != nullptr && std::fwrite(contents.data(), 1, contents.size(), out) == contents.size();
+    if (out) {
+        syncFile(out);
+        written = std::fclose(out) == 0 && written;
+    }
+
+    std::error_code ec;
+    if (written) {
+        fs::rename(tempPath, journalPath, ec);
+    }
+    if (!written || ec) {
+        std::cerr << "ERROR: Could not rewrite favorites journal " << journalPath << std::endl;
+        fs::remove(tempPath, ec);
+    } else {
+        journalRecords = favorites.size();
+        unsynced = false;
+    }
+    journal = std::fopen(journalPath.c_str(), "ab");
+    if (!journal) {
+        std::cerr << "ERROR: Could not open favorites journal " << journalPath << std::endl;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef FAVORITES_STORE_H
+#define FAVORITES_STORE_H
+
+#include "Movie.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * @class FavoritesStore
+ * @brief The user's favorite movies, held in memory and persisted in an append-only journal.
+ *
+ * The journal is a binary file with a versioned header, followed by
+ * length-prefixed records. Each record holds a whole Movie: IMDb ID,
+ * title, year, genre, rating and poster reference. The favorites view
+ * therefore needs no OMDb request. Each favorite's poster is copied out of
+ * the local poster cache into "favorite-posters" next to the journal, so the
+ * cache's LRU eviction never takes it away; posters not downloaded yet are
+ * copied when the journal is next loaded.
+ *
+ * The journal is read on first use. Each add or remove appends one record
+ * instead of rewriting the whole list. Appends are flushed to the OS right
+ * away, but fsync'ed in batches, at most once per syncInterval. When
+ * removed entries make up most of the journal, it is rewritten with only
+ * the live favorites. A lookup table keyed by IMDb ID makes add, remove and
+ * contains O(1).
+ *
+ * Favorites saved by older versions (the text journal and favorites.txt in
+ * the journal's directory) are imported the first time the binary journal
+ * is created. A journal that cannot be read, e.g. one written by a newer
+ * version, is renamed to "<journal>.bad" and never overwritten. All methods
+ * must be called on the GUI thread.
+ */
+class FavoritesStore {
+public:
+    explicit FavoritesStore(const std::string &journalPath = "favorites.bin",
+                            const std::string &posterDirectory = "cache/posters",
+                            std::chrono::milliseconds syncInterval = std::chrono::seconds(1));
+    ~FavoritesStore();
+
+    FavoritesStore(const FavoritesStore &) = delete;
+    FavoritesStore &operator=(const FavoritesStore &) = delete;
+
+    bool add(const Movie &movie);
+    bool remove(const std::string &key);
+    bool contains(const std::string &key);
+    const std::vector<Movie> &movies();
+
+    void sync(bool force = false);
+
+    static std::string keyOf(const Movie &movie);
+
+private:
+    void ensureLoaded();
+    bool load();
+    void importTextJournal(const std::string &path);
+    void importLegacy(const std::string &path);
+    void resolvePoster(Movie &movie) const;
+    void insert(Movie movie);
+    void erase(const std::string &key);
+    void append(char type, const std::string &payload);
+    void compact();
+
+    std::string journalPath;
+    std::string posterDirectory;
+    std::string keptPosterDirectory;// Copies of the favorites' posters
+    std::chrono::milliseconds syncInterval;
+    bool loaded = false;
+
+    std::vector<Movie> favorites;                         // Display order; removal swaps in the last entry
+    std::unordered_map<std::string, size_t> indexByKey;   // Key -> position in favorites
+    std::FILE *journal = nullptr;                         // Open for appending
+    size_t journalRecords = 0;                            // Add and remove records in the journal
+    bool unsynced = false;                                // Appended records not yet fsync'ed
+    std::chrono::steady_clock::time_point firstUnsynced;  // When the oldest unsynced record was written
+};
+
+#endif // FAVORITES_STORE_H
@@ -0,0 +1,108 @@
+#include "FrameStats.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// CPU time used by all threads of the process so far, in seconds
+static double ProcessCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+    ULARGE_INTEGER kernelTime{{kernel.dwLowDateTime, kernel.dwHighDateTime}};
+    ULARGE_INTEGER userTime{{user.dwLowDateTime, user.dwHighDateTime}};
+    return static_cast<double>(kernelTime.QuadPart + userTime.QuadPart) * 1e-7;// 100 ns units
+#else
+    timespec now{};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) return 0.0;
+    return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+#endif
+}
+
+
+void FrameStats::beginFrame() {
+    frameStart = Clock::now();
+    posterWorkMs = 0.0;
+}
+
+/**
+ * @brief Adds time spent on poster decoding or upload to the current frame.
+ */
+void FrameStats::addPosterWork(Clock::duration duration) {
+    posterWorkMs += std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/**
+ * @brief Ends the current frame.
+ *
+ * @param active false if the frame was drawn only because the idle timeout expired.
+ */
+void FrameStats::endFrame(bool active) {
+    Clock::time_point now = Clock::now();
+    double frameMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+    recentMs[frameCount % kWindow] = frameMs;
+    frameCount++;
+    if (frameMs > kBudgetMs) slowFrameCount++;
+    worstFrameMs = std::max(worstFrameMs, frameMs);
+    worstPosterWorkMs = std::max(worstPosterWorkMs, posterWorkMs);
+
+    // Close the CPU sample once it spans long enough
+    sampleActive = sampleActive || active;
+    if (sampleCpuStart < 0.0) {
+        sampleStart = now;
+        sampleCpuStart = ProcessCpuSeconds();
+        return;
+    }
+    double wallSeconds = std::chrono::duration<double>(now - sampleStart).count();
+    if (wallSeconds < kCpuSampleSeconds) return;
+    double cpu = ProcessCpuSeconds();
+    double cpuSeconds = cpu - sampleCpuStart;
+    lastCpuPercent = 100.0 * cpuSeconds / wallSeconds;
+    (sampleActive ? activeCpuSeconds : idleCpuSeconds) += cpuSeconds;
+    (sampleActive ? activeWallSeconds : idleWallSeconds) += wallSeconds;
+    sampleStart = now;
+    sampleCpuStart = cpu;
+    sampleActive = false;
+}
+
+/**
+ * @brief Returns the average CPU usage while idle, in percent of one core.
+ */
+double FrameStats::idleCpuPercent() const {
+    return idleWallSeconds > 0.0 ? 100.0 * idleCpuSeconds / idleWallSeconds : 0.0;
+}
+
+/**
+ * @brief Returns the average CPU usage while active, in percent of one core.
+ */
+double FrameStats::activeCpuPercent() const {
+    return activeWallSeconds > 0.0 ? 100.0 * activeCpuSeconds / activeWallSeconds : 0.0;
+}
+
+/**
+ * @brief Returns the average frame time over the last kWindow frames.
+ */
+double FrameStats::averageMs() const {
+    size_t count = std::min<uint64_t>(frameCount, kWindow);
+    if (count == 0) return 0.0;
+    double total = 0.0;
+    for (size_t i = 0; i < count; i++) total += recentMs[i];
+    return total / count;
+}
+
+/**
+ * @brief Writes a one-line summary of the frame times.
+ */
+void FrameStats::report(std::ostream &out) const {
+    out << "Frame stats: " << frameCount << " frames, avg " << averageMs() << " ms, worst " << worstFrameMs
+        << " ms, worst poster work " << worstPosterWorkMs << " ms, " << slowFrameCount << " frames over "
+        << kBudgetMs << " ms" << std::endl;
+    out << "CPU usage: idle " << idleCpuPercent() << "% over " << idleWallSeconds << " s, active "
+        << activeCpuPercent() << "% over " << activeWallSeconds << " s (percent of one core)" << std::endl;
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+
+/**
+ * @class FrameStats
+ * @brief Measures how long the GUI thread spends building each frame.
+ *
+ * Tracks the CPU time of every frame (excluding the wait for V-Sync), the
+ * part of it spent on poster work, the worst frame seen and how many frames
+ * missed a 60 Hz deadline. It also samples the process CPU usage about once
+ * a second, split into idle periods (frames drawn only because a timeout
+ * expired) and active ones (input, arriving results, poster uploads).
+ */
+class FrameStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void beginFrame();
+    void addPosterWork(Clock::duration duration);
+    void endFrame(bool active = true);
+
+    double averageMs() const;
+    double worstMs() const { return worstFrameMs; }
+    double worstPosterMs() const { return worstPosterWorkMs; }
+    uint64_t frames() const { return frameCount; }
+    uint64_t slowFrames() const { return slowFrameCount; }
+    double cpuPercent() const { return lastCpuPercent; }
+    double idleCpuPercent() const;
+    double activeCpuPercent() const;
+
+    void report(std::ostream &out) const;
+
+private:
+    static constexpr size_t kWindow = 120;// Frames in the rolling average
+    static constexpr double kBudgetMs = 1000.0 / 60.0;
+
+    Clock::time_point frameStart;
+    double posterWorkMs = 0.0;
+    std::array<double, kWindow> recentMs{};
+    uint64_t frameCount = 0;
+    uint64_t slowFrameCount = 0;
+    double worstFrameMs = 0.0;
+    double worstPosterWorkMs = 0.0;
+
+    // CPU usage, sampled over windows of at least kCpuSampleSeconds
+    static constexpr double kCpuSampleSeconds = 1.0;
+    Clock::time_point sampleStart;
+    double sampleCpuStart = -1.0;// Process CPU seconds at sampleStart, negative before the first frame
+    bool sampleActive = false;   // Any frame in the window was active
+    double lastCpuPercent = 0.0;
+    double idleCpuSeconds = 0.0, idleWallSeconds = 0.0;
+    double activeCpuSeconds = 0.0, activeWallSeconds = 0.0;
+};
+
+#endif // FRAME_STATS_H
@@ -1,5 +1,7 @@
 #include "GuiManager.h"
+#include "MovieJson.h"
 #include "ImageLoader.h"
+#include <optional>
 #include <algorithm>
 #include <iostream>
 #include <regex>
@@ -17,6 +19,7 @@ ImFont *HadFontSolid = nullptr;  // Font for solid icons
  * This constructor initializes the ImGui library and sets up the fonts and styles for the GUI.
  *
  * @param window A pointer to the GLFWwindow object.
+ * @param scheduler Task scheduler running the poster decodes; must be shut down before the GuiManager is destroyed.
  *
  * The constructor performs the following tasks:
  * - Checks the ImGui version.
@@ -26,7 +29,8 @@ ImFont *HadFontSolid = nullptr;  // Font for solid icons
  * - Sets the ImGui style to light.
  * - Initializes ImGui for GLFW and OpenGL.
  */
-GuiManager::GuiManager(GLFWwindow *window) : window(window) {
+GuiManager::GuiManager(GLFWwindow *window, TaskScheduler &scheduler)
+    : window(window), textureLoader(scheduler, posterAtlas.thumbnailWidth(), posterAtlas.thumbnailHeight()), movieTable(&scheduler) {
     // Initialize ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -60,114 +64,128 @@ GuiManager::GuiManager(GLFWwindow *window) : window(window) {
     ImGui::StyleColorsLight();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
+
+    // Decode tasks wake the main loop when a poster is ready for upload
+    textureLoader.setWakeCallback(glfwPostEmptyEvent);
+    // Sorts of large result sets run in the background and wake the main loop when done
+    movieTable.setWakeCallback(glfwPostEmptyEvent);
 }
 
 GuiManager::~GuiManager() {
-    std::string cachePath = "cache/";
-
-    try {
-        if (fs::exists(cachePath) && fs::is_directory(cachePath)) {
-            for (const auto &entry: fs::directory_iterator(cachePath)) {
-                fs::remove(entry.path());
-            }
-        }
-    } catch (const fs::filesystem_error &e) {
-        std::cerr << "Error deleting cache files: " << e.what() << std::endl;
-    }
+    frameStats.report(std::cout);
+    // Posters stay in the persistent poster cache for the next session
     // Cleanup ImGui
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 }
-std::vector<Movie> favoriteMovies;// List of favorite movies
-std::mutex fileMutex;             // Protects file access
-
-// Function to save favorite movies to a file
-void saveFavoritesToFile() {
-    std::lock_guard<std::mutex> lock(fileMutex);
-    std::ofstream outFile("favorites.txt");
-
-    if (!outFile) {
-        std::cerr << "Error: Could not open file for writing." << std::endl;
-        return;
-    }
-
-    for (const auto &movie: favoriteMovies) {
-        outFile << movie.title << "," << movie.year << std::endl;
+// Draws a poster thumbnail from the atlas, decoded in the background on first use
+void GuiManager::drawPoster(const Movie &movie, const ImVec2 &posterSize) {
+    if (std::optional<TextureAtlas::Region> poster = posterAtlas.find(movie.imdbID)) {
+        ImGui::Image(poster->texture, posterSize, poster->uv0, poster->uv1);// Display the poster image
+    } else if (!movie.posterPath.empty() && textureLoader.request(movie.imdbID, movie.posterPath)) {
+        ImGui::Text("Loading...");// Poster is still being decoded
+    } else {
+        ImGui::Text("No Image");// Display text if image not found
     }
-
-    outFile.close();
 }
 
-
-// Function to load favorite movies from file
-void loadFavoritesFromFile() {
-    std::lock_guard<std::mutex> lock(fileMutex);
-    std::ifstream inFile("favorites.txt");
-
-    if (!inFile) {
-        std::cerr << "Warning: No existing favorites file found." << std::endl;
+// Draws the genre, year and rating filters of the results table
+void GuiManager::drawFilterPanel() {
+    if (!ImGui::CollapsingHeader("Filters")) {
         return;
     }
+    MovieTable::Filter filter = movieTable.filter();
+
+    // Genre facets: each checkbox shows how many results would remain with that genre required
+    int shown = 0;
+    for (size_t bit = 0; bit < movieTable.genreCount(); bit++) {
+        uint64_t mask = uint64_t(1) << bit;
+        bool selected = (filter.genres & mask) != 0;
+        uint32_t matches = movieTable.genreMatches(bit);
+        if (matches == 0 && !selected) {
+            continue;// Genre of an earlier search only
+        }
+        if (shown++ % 6 != 0) ImGui::SameLine();
+        std::string label = movieTable.genreName(bit) + " (" + std::to_string(matches) + ")";
+        if (ImGui::Checkbox(label.c_str(), &selected)) {
+            filter.genres = selected ? filter.genres | mask : filter.genres & ~mask;
+        }
+    }
 
-    favoriteMovies.clear();// Clear the list before loading
-    std::string line;
-    while (std::getline(inFile, line)) {
-        size_t commaPos = line.find(",");
-        if (commaPos != std::string::npos) {
-            std::string title = line.substr(0, commaPos);
-            std::string year = line.substr(commaPos + 1);
-            favoriteMovies.push_back({title, year});
+    // Year range, open while it spans every known year
+    int minKnown = movieTable.minKnownYear();
+    int maxKnown = movieTable.maxKnownYear();
+    if (minKnown > 0) {
+        int fromYear = filter.minYear == 0 ? minKnown : filter.minYear;
+        int toYear = filter.maxYear == 65535 ? maxKnown : filter.maxYear;
+        ImGui::PushItemWidth(300.0f);
+        if (ImGui::DragIntRange2("Year", &fromYear, &toYear, 0.25f, minKnown, maxKnown)) {
+            bool open = fromYear <= minKnown && toYear >= maxKnown;
+            filter.minYear = open ? 0 : static_cast<uint16_t>(fromYear);
+            filter.maxYear = open ? 65535 : static_cast<uint16_t>(toYear);
         }
+        ImGui::PopItemWidth();
     }
 
-    inFile.close();
-}
-void addMovieToFavorites(const Movie &movie) {
-    for (const auto &fav: favoriteMovies) {
-        if (fav.title == movie.title)
-            return;
+    // Minimum IMDb rating; 0 also shows unrated movies
+    float minRating = filter.minRating < 0 ? 0.0f : filter.minRating / 10.0f;
+    ImGui::PushItemWidth(300.0f);
+    if (ImGui::SliderFloat("Minimum rating", &minRating, 0.0f, 10.0f, "%.1f")) {
+        filter.minRating = minRating <= 0.0f ? int16_t(-1) : static_cast<int16_t>(minRating * 10.0f + 0.5f);
     }
+    ImGui::PopItemWidth();
 
-    favoriteMovies.push_back(movie);
-    saveFavoritesToFile();
+    if (filter.active() && ImGui::Button("Clear filters")) {
+        filter = MovieTable::Filter();
+    }
+    movieTable.setFilter(filter);
 }
 
-void removeMovieFromFavorites(const Movie &movieToRemove) {
-    // Find and remove the movie that matches both title and year
-    auto it = std::remove_if(favoriteMovies.begin(), favoriteMovies.end(),
-                             [&movieToRemove](const Movie &movie) {
-                                 return (movie.title == movieToRemove.title && movie.year == movieToRemove.year);
-                             });
-
-    if (it != favoriteMovies.end()) {
-        favoriteMovies.erase(it, favoriteMovies.end());// Remove matching elements
-        saveFavoritesToFile();                         // Save updated list to file
-        std::cout << "Movie removed from favorites: " << movieToRemove.title << " (" << movieToRemove.year << ")" << std::endl;
+// Removes a favorite and reports it on the console
+void GuiManager::removeFavorite(const Movie &movie) {
+    if (favorites.remove(FavoritesStore::keyOf(movie))) {
+        std::cout << "Movie removed from favorites: " << movie.title << " (" << movie.year << ")" << std::endl;
     } else {
-        std::cout << "Movie not found in favorites: " << movieToRemove.title << " (" << movieToRemove.year << ")" << std::endl;
+        std::cout << "Movie not found in favorites: " << movie.title << " (" << movie.year << ")" << std::endl;
     }
 }
 
+/**
+ * @brief Waits until the next frame is needed.
+ *
+ * Returns immediately while the GUI is busy (recent input, pending poster
+ * uploads). Otherwise the thread sleeps in glfwWaitEventsTimeout() until an
+ * input event arrives, a background task posts an empty event, or the next
+ * timed redraw (search debounce, caret blink) is due.
+ */
+void GuiManager::waitForEvents() {
+    double timeout = idleTimeout();
+    if (timeout <= 0.0) {
+        glfwPollEvents();
+        wokeByEvent = false;
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    glfwWaitEventsTimeout(timeout);
+    wokeByEvent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < timeout;
+}
 
-enum SortColumn { None,
-                  Title,
-                  Year,
-                  Rating };
-SortColumn currentSortColumn = None;
-bool sortAscending = true;// Track ascending/descending state
-
-// Sorting function
-void sortMovies(std::vector<Movie> &movies) {
-    if (currentSortColumn == None) return;
-
-    std::sort(movies.begin(), movies.end(), [](const Movie &a, const Movie &b) {
-        if (currentSortColumn == Title) return (sortAscending) ? (a.title < b.title) : (a.title > b.title);
-        if (currentSortColumn == Year) return (sortAscending) ? (a.year < b.year) : (a.year > b.year);
-        if (currentSortColumn == Rating) return (sortAscending) ? (a.imdbRating < b.imdbRating) : (a.imdbRating > b.imdbRating);
-        return false;
-    });
+// Seconds the main loop may sleep before the next frame, 0 to draw right away
+double GuiManager::idleTimeout() {
+    if (settleFrames > 0 || textureLoader.hasPendingUploads()) {
+        return 0.0;
+    }
+    double timeout = idleTimeoutSeconds;
+    if (editPending) {
+        // Wake up when the search debounce expires
+        timeout = std::min(timeout, std::chrono::duration<double>(lastEdit + searchDebounce - std::chrono::steady_clock::now()).count());
+    }
+    if (ImGui::GetIO().WantTextInput) {
+        timeout = std::min(timeout, caretBlinkSeconds);
+    }
+    return timeout;
 }
 
 /**
@@ -180,19 +198,46 @@ void sortMovies(std::vector<Movie> &movies) {
  * @param searchQuery Reference to the search query string.
  * @param movies Reference to the vector of movies to display.
  * @param moviesMutex Mutex to protect access to the movies vector.
- * @param isSearching Atomic boolean indicating if a search is in progress.
+ * @param resultFeed Feed of streamed search results, drained into movies every frame.
  * @param queryCopy Copy of the search query string.
  * @param apiKey API key for downloading movie posters.
  */
 void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, std::mutex &moviesMutex,
-                        std::atomic<bool> &isSearching,
-                        std::string queryCopy, const std::string &apiKey) {
-    // Load favorite movies from file
-    loadFavoritesFromFile();
+                        ResultFeed &resultFeed, std::string queryCopy, const std::string &apiKey) {
+    frameStats.beginFrame();
+    // Write batched favorites changes to disk once they are old enough
+    favorites.sync();
+    bool active = wokeByEvent;// Something changed this frame, keep drawing for a few frames
+    // Append the movies and posters that arrived since the last frame
+    {
+        std::lock_guard<std::mutex> lock(moviesMutex);
+        bool reset = false;
+        if (resultFeed.drain(movies, &reset)) {
+            active = true;
+        }
+        // Index the new rows, merge them into the current sort order and pick up finished sorts
+        if (movieTable.sync(movies, reset)) {
+            active = true;
+        }
+    }
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
+    // Input handled this frame
+    ImGuiIO &io = ImGui::GetIO();
+    if (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f || io.MouseWheel != 0.0f ||
+        ImGui::IsAnyMouseDown() || !io.InputQueueCharacters.empty()) {
+        active = true;
+    }
+
+    // Upload posters decoded in the background, within the per-frame budget
+    posterAtlas.beginFrame();
+    if (textureLoader.hasPendingUploads()) {
+        frameStats.addPosterWork(textureLoader.uploadPending(posterAtlas));
+        active = true;
+    }
+
     ImVec2 windowSize = ImGui::GetIO().DisplaySize;
     float centerX = windowSize.x * 0.5f;
     // Main Window
@@ -214,10 +259,23 @@ void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, st
     ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 12.0f);
     static char buffer[128] = "";
     ImGui::PushItemWidth(searchBarWidth);
-    ImGui::InputText("##search", buffer, sizeof(buffer), ImGuiInputTextFlags_AutoSelectAll);
+    if (ImGui::InputText("##search", buffer, sizeof(buffer), ImGuiInputTextFlags_AutoSelectAll)) {
+        lastEdit = std::chrono::steady_clock::now();
+        editPending = true;
+    }
     ImGui::PopItemWidth();
     ImGui::PopStyleVar();
 
+    // Search as the user types, once they pause long enough; the previous search is cancelled
+    if (editPending && std::chrono::steady_clock::now() - lastEdit >= searchDebounce) {
+        editPending = false;
+        std::string typed = buffer;
+        if (typed.size() >= minSearchLength && typed != submittedQuery) {
+            searchQuery = typed;
+            submittedQuery = typed;
+        }
+    }
+
 
     // flag to check if the search query is empty
     bool flag = false;
@@ -226,17 +284,16 @@ void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, st
     ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 12.0f);
 
     ImGui::SetCursorPosX(centerX - 40);
-    if (ImGui::Button("Search", ImVec2(80, 30))) {
-        if (!isSearching) {
-            searchQuery = buffer;
-            isSearching = true;
-        }
+    if (ImGui::Button("Search", ImVec2(80, 30)) && buffer[0] != '\0') {
+        searchQuery = buffer;// Search right away, even if the query did not change
+        submittedQuery = buffer;
+        editPending = false;
     }
     ImGui::PopStyleVar();
 
 
 
-    bool searching = isSearching.load(std::memory_order_relaxed);
+    bool searching = resultFeed.searching();
     if (!searching) flag = true;
 
     // Display search query in center
@@ -245,8 +302,22 @@ void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, st
         ImGui::Text("Searching...");
     }
 
+    // Display how many of the matches have been loaded so far
+    if (int totalResults = resultFeed.totalResults(); totalResults > 0 && !movies.empty()) {
+        std::string loaded = "Showing " + std::to_string(movies.size()) + " of " + std::to_string(totalResults) + " results";
+        if (movieTable.filter().active()) {
+            loaded += ", " + std::to_string(movieTable.size()) + " match the filters";
+        }
+        if (movieTable.sorting()) {
+            loaded += " (sorting...)";
+        }
+        ImGui::SetCursorPosX(centerX - ImGui::CalcTextSize(loaded.c_str()).x * 0.5f);
+        ImGui::Text("%s", loaded.c_str());
+    }
+
     // Display search results with sorting
     if (!movies.empty()) {
+        drawFilterPanel();
         ImGui::SetCursorPosX(5);                                                      // Set cursor position to left
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(10.0f, 10.0f));         // Set spacing between items
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(5.0f, 5.0f));          // Set padding for frames
@@ -260,93 +331,113 @@ void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, st
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.1f, 0.4f, 0.8f, 1.0f)); // Set button active color
 
         // Display table with search results
-        if (ImGui::BeginTable("Movies Table", 6, ImGuiTableFlags_Sortable | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Borders | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_BordersOuter))// Table with 6 columns and sortable
+        if (ImGui::BeginTable("Movies Table", 6, ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Borders | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_BordersOuter))// Table with 6 columns, sortable by several columns at once
         {
 
             ImGui::TableSetupColumn("Poster", ImGuiTableColumnFlags_WidthFixed, 100.0f);                                            // Fixed width for poster
-            ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 600.0f, Title);// Default sort by title
-            ImGui::TableSetupColumn("Year", ImGuiTableColumnFlags_DefaultSort, 100.0f, Year);                                       // Default sort by year
-            ImGui::TableSetupColumn("Genre", ImGuiTableColumnFlags_WidthStretch, 300.0f);                                           // Stretch to fill available space
-            ImGui::TableSetupColumn("IMDB Rating", ImGuiTableColumnFlags_DefaultSort, 100.0f, Rating);                              // Default sort by rating
+            ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 600.0f, MovieTable::Title);// Default sort by title
+            ImGui::TableSetupColumn("Year", ImGuiTableColumnFlags_DefaultSort, 100.0f, MovieTable::Year);                                       // Default sort by year
+            ImGui::TableSetupColumn("Genre", ImGuiTableColumnFlags_WidthStretch, 300.0f);                                                       // Stretch to fill available space
+            ImGui::TableSetupColumn("IMDB Rating", ImGuiTableColumnFlags_DefaultSort, 100.0f, MovieTable::Rating);                              // Default sort by rating
             ImGui::TableSetupColumn("");                                                                                            // Empty column for like button
             ImGui::TableHeadersRow();                                                                                               // Headers Row
 
             // Sorting Logic
             if (ImGuiTableSortSpecs *sortSpecs = ImGui::TableGetSortSpecs()) {
-                if (sortSpecs->SpecsDirty && sortSpecs->SpecsCount > 0) {
-                    const ImGuiTableColumnSortSpecs *sortSpec = &sortSpecs->Specs[0];
-                    // Set current sort column and direction
-                    currentSortColumn = static_cast<SortColumn>(sortSpec->ColumnUserID);
-                    sortAscending = (sortSpec->SortDirection == ImGuiSortDirection_Ascending);
-                    // Sort the movies vector
-                    sortMovies(movies);
+                if (sortSpecs->SpecsDirty) {
+                    // Shift-click adds columns; reorder the rows by all of them, the movies themselves stay in place
+                    std::vector<MovieTable::SortKey> sortKeys;
+                    for (int n = 0; n < sortSpecs->SpecsCount; n++) {
+                        const ImGuiTableColumnSortSpecs &sortSpec = sortSpecs->Specs[n];
+                        sortKeys.push_back({static_cast<MovieTable::Column>(sortSpec.ColumnUserID),
+                                            sortSpec.SortDirection == ImGuiSortDirection_Ascending});
+                    }
+                    movieTable.sortBy(sortKeys);
                     sortSpecs->SpecsDirty = false;
                 }
             }
 
             std::lock_guard<std::mutex> lock(moviesMutex);// Lock the movies vector while reading
-            // Display each movie in a row of the table with title, year, genre, rating, poster, and like button columns
-            for ( auto &movie: movies) {
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(1);
-                ImGui::Text("%s", movie.title.c_str());
-                ImGui::TableSetColumnIndex(2);
-                ImGui::Text("%s", movie.year.c_str());
-                ImGui::TableSetColumnIndex(3);
-                ImGui::Text("%s", movie.genre.c_str());
-                ImGui::TableSetColumnIndex(4);
-                ImGui::Text("%s", movie.imdbRating.c_str());
-                ImGui::TableSetColumnIndex(0);
-                //Path of the poster image
-                std::string posterPath = "cache/" + movie.title + ".jpg";
-
-
-                //loading poster from local file
-                if(movie.texture==-1) {
-                     movie.texture = LoadTextureFromFile(posterPath);
+            ImVec2 posterSize(static_cast<float>(posterAtlas.thumbnailWidth()), static_cast<float>(posterAtlas.thumbnailHeight()));
+            int visibleStart = 0;// First row on screen
+            int rowsReached = 0; // Rows up to the last one on screen
+            size_t arrivedReached = 0;// Rows received up to the latest-arriving one on screen; the filter and sort reorder them
+            // Only rows on screen are submitted; every row is as tall as a poster so the clipper can skip the others
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(movieTable.size()));
+            while (clipper.Step()) {
+                if (clipper.DisplayEnd > rowsReached) {
+                    visibleStart = clipper.DisplayStart;
+                    rowsReached = clipper.DisplayEnd;
                 }
-                if (movie.texture) {
-                    ImGui::Image((ImTextureID) (uintptr_t) movie.texture, ImVec2(100, 150));// Display the poster image
-                } else {
-                    ImGui::Text("No Image");// Display text if image not found
-                    movie.texture=0;
+                // Display each movie in a row of the table with title, year, genre, rating, poster, and like button columns
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    uint32_t row = movieTable.rowAt(i);
+                    arrivedReached = std::max(arrivedReached, static_cast<size_t>(row) + 1);
+                    Movie &movie = movies[row];
+                    int id = ParseImdbNumber(movie.imdbID);
+                    ImGui::PushID(id >= 0 ? id : -1 - i);// IMDb number survives sorting, the row index is a fallback
+                    ImGui::TableNextRow(ImGuiTableRowFlags_None, posterSize.y);
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%s", movie.title.c_str());
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%s", movie.year.c_str());
+                    ImGui::TableSetColumnIndex(3);
+                    ImGui::Text("%s", movie.genre.c_str());
+                    ImGui::TableSetColumnIndex(4);
+                    ImGui::Text("%s", movie.imdbRating.c_str());
+                    ImGui::TableSetColumnIndex(0);
+                    drawPoster(movie, posterSize);
+
+                    ImGui::TableSetColumnIndex(5);
+
+                    ImVec2 buttonSize(30, 30);// Size of the like button
+                    // Invisible button for like button
+                    if (ImGui::InvisibleButton("##Like", buttonSize)) {
+                        favorites.add(movie);// Add movie to favorites if button is clicked
+                    }
+
+                    bool isHovered = ImGui::IsItemHovered();
+
+
+                    ImVec2 buttonMin = ImGui::GetItemRectMin();                                                         // Get minimum position of the button
+                    ImVec2 iconPos = ImVec2(buttonMin.x + (buttonSize.x / 2) - 8, buttonMin.y + (buttonSize.y / 2) - 8);// Position of the icon
+                    ImGui::SetCursorScreenPos(iconPos);                                                                 // Set cursor position to icon position
+
+                    if(isHovered){
+                        if (iconFontSolid) ImGui::PushFont(iconFontSolid);// Set font for like button
+
+                        ImGui::Text("\xef\x80\x84");
+                        // Pop font after displaying the icon
+                        if (iconFontSolid) ImGui::PopFont();
+
+                    }
+                    else {
+                        if (iconFontRegular) ImGui::PushFont(iconFontRegular);// Set font for like button
+
+                        ImGui::Text("\xef\x80\x85");// Display the like icon
+                        if (iconFontRegular) ImGui::PopFont();
+
+                    }
+                    ImGui::PopID();
                 }
-
-                ImGui::TableSetColumnIndex(5);
-
-
-                std::string buttonID = "##Like" + movie.title + movie.year;// Button ID for like button
-
-                ImVec2 buttonSize(30, 30);// Size of the like button
-                // Invisible button for like button
-                if (ImGui::InvisibleButton(buttonID.c_str(), buttonSize)) {
-                    addMovieToFavorites(movie);// Add movie to favorites if button is clicked
-                }
-
-                bool isHovered = ImGui::IsItemHovered();
-
-
-                ImVec2 buttonMin = ImGui::GetItemRectMin();                                                         // Get minimum position of the button
-                ImVec2 iconPos = ImVec2(buttonMin.x + (buttonSize.x / 2) - 8, buttonMin.y + (buttonSize.y / 2) - 8);// Position of the icon
-                ImGui::SetCursorScreenPos(iconPos);                                                                 // Set cursor position to icon position
-
-                if(isHovered){
-                    if (iconFontSolid) ImGui::PushFont(iconFontSolid);// Set font for like button
-
-                    ImGui::Text("\xef\x80\x84");
-                    // Pop font after displaying the icon
-                    if (iconFontSolid) ImGui::PopFont();
-
-                }
-                else {
-                    if (iconFontRegular) ImGui::PushFont(iconFontRegular);// Set font for like button
-
-                    ImGui::Text("\xef\x80\x85");// Display the like icon
-                    if (iconFontRegular) ImGui::PopFont();
-
+            }
+            // Pages are fetched by rows received, so report those. Once the filtered list is exhausted on
+            // screen, every received row counts as reached and the search keeps paging for more matches.
+            bool listExhausted = static_cast<size_t>(rowsReached) >= movieTable.size();
+            resultFeed.setVisibleRows(listExhausted ? movieTable.totalRows() : arrivedReached);
+
+            // Decode the posters just above and below the screen so they are ready when scrolled into view
+            auto prefetchPoster = [this](const Movie &movie) {
+                if (!movie.posterPath.empty() && !posterAtlas.contains(movie.imdbID)) {
+                    textureLoader.request(movie.imdbID, movie.posterPath, TaskPriority::Background);
                 }
-
-
+            };
+            for (int i = std::max(0, visibleStart - posterPrefetchRows); i < visibleStart; i++) {
+                prefetchPoster(movies[movieTable.rowAt(i)]);
+            }
+            for (int i = rowsReached; i < std::min(static_cast<int>(movieTable.size()), rowsReached + posterPrefetchRows); i++) {
+                prefetchPoster(movies[movieTable.rowAt(i)]);
             }
 
             ImGui::EndTable();
@@ -368,44 +459,94 @@ void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, st
     // Display favorite movies
     ImGui::Separator();                                                                                                                                                                                                             // Separator line
     ImGui::Text("Favorite Movies:");                                                                                                                                                                                                // Title for favorite movies
-    if (ImGui::BeginTable("Favorites Table", 3, ImGuiTableFlags_Sortable | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Borders | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_BordersOuter))// Table with 3 columns
+    if (ImGui::BeginTable("Favorites Table", 6, ImGuiTableFlags_Sortable | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Borders | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_BordersOuter))// Table with 6 columns
     {
-        ImGui::TableSetupColumn("Title");
-        ImGui::TableSetupColumn("Year");
+        ImGui::TableSetupColumn("Poster", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+        ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_WidthStretch, 600.0f);
+        ImGui::TableSetupColumn("Year", ImGuiTableColumnFlags_None, 100.0f);
+        ImGui::TableSetupColumn("Genre", ImGuiTableColumnFlags_WidthStretch, 300.0f);
+        ImGui::TableSetupColumn("IMDB Rating", ImGuiTableColumnFlags_None, 100.0f);
         ImGui::TableSetupColumn("");
         ImGui::TableHeadersRow();
-        // Display each favorite movie in a row of the table with title, year, and dislike button columns
-        for (const auto &movie: favoriteMovies) {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("%s", movie.title.c_str());
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("%s", movie.year.c_str());
-
-            ImGui::TableSetColumnIndex(2);
-
-            if (iconFontSolid) ImGui::PushFont(iconFontSolid);// Set font for dislike button
-            // Button ID for dislike button
-            std::string buttonID = "##Dislike" + movie.title + movie.year;
-
-            ImVec2 buttonSize(30, 30);
-            // Invisible button for dislike button
-            if (ImGui::InvisibleButton(buttonID.c_str(), buttonSize)) {
-                removeMovieFromFavorites(movie);
-            }
+        // Favorites carry their own details and cached poster, so the table needs no network requests
+        ImVec2 posterSize(static_cast<float>(posterAtlas.thumbnailWidth()), static_cast<float>(posterAtlas.thumbnailHeight()));
+        int removeIndex = -1;// Removed after the loop, the list must not change while it is drawn
+        ImGuiListClipper clipper;
+        const std::vector<Movie> &favoriteMovies = favorites.movies();
+        clipper.Begin(static_cast<int>(favoriteMovies.size()));
+        while (clipper.Step()) {
+            // Display each favorite movie in a row of the table with poster, title, year, genre, rating, and dislike button columns
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                const Movie &movie = favoriteMovies[i];
+                ImGui::PushID(i);
+                ImGui::TableNextRow(ImGuiTableRowFlags_None, posterSize.y);
+                ImGui::TableSetColumnIndex(0);
+                drawPoster(movie, posterSize);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%s", movie.title.c_str());
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%s", movie.year.c_str());
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%s", movie.genre.c_str());
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%s", movie.imdbRating.c_str());
+
+                ImGui::TableSetColumnIndex(5);
+
+                if (iconFontSolid) ImGui::PushFont(iconFontSolid);// Set font for dislike button
+
+                ImVec2 buttonSize(30, 30);
+                // Invisible button for dislike button
+                if (ImGui::InvisibleButton("##Dislike", buttonSize)) {
+                    removeIndex = i;
+                }
 
-            ImVec2 buttonMin = ImGui::GetItemRectMin();
-            ImVec2 iconPos = ImVec2(buttonMin.x + (buttonSize.x / 2) - 8, buttonMin.y + (buttonSize.y / 2) - 8);
-            ImGui::SetCursorScreenPos(iconPos);
-            ImGui::Text("\xef\x80\x84");
+                ImVec2 buttonMin = ImGui::GetItemRectMin();
+                ImVec2 iconPos = ImVec2(buttonMin.x + (buttonSize.x / 2) - 8, buttonMin.y + (buttonSize.y / 2) - 8);
+                ImGui::SetCursorScreenPos(iconPos);
+                ImGui::Text("\xef\x80\x84");
 
 
-            if (iconFontSolid) ImGui::PopFont();
+                if (iconFontSolid) ImGui::PopFont();
+                ImGui::PopID();
+            }
+        }
+        if (removeIndex >= 0) {
+            Movie removed = favoriteMovies[removeIndex];// Copy, the element is overwritten while erasing
+            removeFavorite(removed);
         }
         // End table for favorite movies
         ImGui::EndTable();
     }
 
+    // Frame time overlay, toggled with F3
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+        showFrameStats = !showFrameStats;
+    }
+    if (showFrameStats) {
+        ImGui::Separator();
+        ImGui::Text("Frame: avg %.2f ms, worst %.2f ms, worst poster work %.2f ms, %llu slow frames",
+                    frameStats.averageMs(), frameStats.worstMs(), frameStats.worstPosterMs(),
+                    (unsigned long long) frameStats.slowFrames());
+        ImGui::Text("CPU: %.1f%% now, idle %.1f%%, active %.1f%% (of one core)",
+                    frameStats.cpuPercent(), frameStats.idleCpuPercent(), frameStats.activeCpuPercent());
+        if (api) {
+            ResponseCache::Stats cache = api->responseCacheStats();
+            ImGui::Text("Response cache: %llu hits, %llu misses, %llu entries", (unsigned long long) cache.hits,
+                        (unsigned long long) cache.misses, (unsigned long long) cache.entries);
+            auto requests = api->requestStats();
+            auto posters = api->posterStats();
+            ImGui::Text("Coalesced: %llu of %llu OMDb requests, %llu of %llu posters", (unsigned long long) requests.coalesced,
+                        (unsigned long long) (requests.issued + requests.coalesced), (unsigned long long) posters.coalesced,
+                        (unsigned long long) (posters.issued + posters.coalesced));
+            RequestLimiter::State limiter = api->limiterState();
+            ImGui::Text("Request limiter: %llu of %llu daily requests, %zu waiting, %llu refused, concurrency %d%s",
+                        (unsigned long long) limiter.usedToday, (unsigned long long) limiter.dailyBudget, limiter.waiting,
+                        (unsigned long long) limiter.refused, static_cast<int>(limiter.concurrencyLimit),
+                        limiter.quotaExhausted ? ", quota exhausted" : "");
+        }
+    }
+
     // End main window
     ImGui::End();
 
@@ -417,6 +558,8 @@ void GuiManager::render(std::string &searchQuery, std::vector<Movie> &movies, st
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);                  // Clear color
     glClear(GL_COLOR_BUFFER_BIT);                          // Clear color buffer
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());// Render draw data
+    frameStats.endFrame(active || settleFrames > 0);       // Frame time excludes the wait for V-Sync
+    settleFrames = active ? settleFrameCount : std::max(0, settleFrames - 1);
 
     glfwSwapBuffers(window);// Swap buffers
 }
@@ -11,7 +11,16 @@
 #include <string>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include "Movie.h"
+#include "ResultFeed.h"
+#include "TextureAtlas.h"
+#include "TaskScheduler.h"
+#include "TextureLoader.h"
+#include "FrameStats.h"
+#include "FavoritesStore.h"
+#include "MovieTable.h"
+#include "OMDbApi.h"
 #include <filesystem>
 #include <iostream>
 namespace fs = std::filesystem;
@@ -24,14 +33,44 @@ namespace fs = std::filesystem;
 for rendering and input handling.**/
 class GuiManager {
 public:
-    GuiManager(GLFWwindow* window);
+    GuiManager(GLFWwindow* window, TaskScheduler& scheduler);
     ~GuiManager();
 
-    void render(std::string &searchQuery, std::vector<Movie> &movies, std::mutex &moviesMutex,
-                      std::atomic<bool> &isSearching, std::string queryCopy, const std::string& apiKey);
+    void render(std::string &searchQuery, std::vector<Movie> &movies, std::mutex &moviesMutex, ResultFeed &resultFeed,
+                      std::string queryCopy, const std::string& apiKey);
+    void setShowFrameStats(bool show) { showFrameStats = show; }
+    void setApi(const OMDbApi* api) { this->api = api; }
+    void waitForEvents();
 
 private:
+    double idleTimeout();
+    void drawPoster(const Movie &movie, const ImVec2 &posterSize);
+    void drawFilterPanel();
+    void removeFavorite(const Movie &movie);
+
     GLFWwindow* window;
+    TextureAtlas posterAtlas;      // Poster thumbnails on the GPU, keyed by IMDb ID
+    TextureLoader textureLoader;   // Decodes posters off the render thread
+    FrameStats frameStats;         // Frame time instrumentation
+    FavoritesStore favorites;      // Read on first use, changes are appended to a journal
+    MovieTable movieTable;         // Sort keys and display order of the results table
+    bool showFrameStats = false;   // Frame time overlay, toggled with F3
+    const OMDbApi* api = nullptr;  // Cache, coalescing and limiter counters shown in the overlay
+    static constexpr int posterPrefetchRows = 3;// Rows above and below the screen whose posters are decoded ahead
+
+    // Idle-aware main loop: frames are only drawn after input, arriving work or a timeout
+    static constexpr int settleFrameCount = 3;     // Frames drawn after activity so ImGui's layout and hover state settle
+    static constexpr double idleTimeoutSeconds = 1.0;// Longest sleep while nothing happens
+    static constexpr double caretBlinkSeconds = 0.5; // Redraw interval while the search bar shows a blinking caret
+    int settleFrames = settleFrameCount;           // Frames still to draw before the loop may sleep
+    bool wokeByEvent = false;                      // The last wait ended because of an event, not the timeout
+
+    // Search-as-you-type: a query is submitted once typing pauses for searchDebounce
+    static constexpr std::chrono::milliseconds searchDebounce{300};
+    static constexpr size_t minSearchLength = 3;      // Shorter queries only search on the button
+    std::string submittedQuery;                       // Last query handed to the search thread
+    std::chrono::steady_clock::time_point lastEdit;   // When the search bar was last edited
+    bool editPending = false;                         // The search bar changed since the last submit
 };
 
 #endif // GUI_MANAGER_H
@@ -0,0 +1,90 @@
+#include "HostConnectionPool.h"
+#include <algorithm>
+
+
+/**
+ * @brief Constructs a connection pool for the given host.
+ *
+ * @param host Host name to connect to.
+ * @param port TCP port of the host.
+ * @param maxConnections Maximum number of simultaneous connections to the host.
+ */
+HostConnectionPool::HostConnectionPool(const std::string &host, int port, size_t maxConnections)
+    : host(host), port(port), maxConnections(std::max<size_t>(1, maxConnections)) {}
+
+/**
+ * @brief Performs a GET request using a pooled connection.
+ *
+ * Blocks while every connection to the host is busy.
+ *
+ * @param path Request path including the query string.
+ * @return The httplib result of the request.
+ */
+httplib::Result HostConnectionPool::Get(const std::string &path) {
+    return Get(path, httplib::Headers());
+}
+
+/**
+ * @brief Performs a GET request with extra headers using a pooled connection.
+ *
+ * @param path Request path including the query string.
+ * @param headers Additional request headers, e.g. for a conditional GET.
+ * @return The httplib result of the request.
+ */
+httplib::Result HostConnectionPool::Get(const std::string &path, const httplib::Headers &headers) {
+    std::unique_ptr<httplib::Client> client = acquire();
+    httplib::Result res = client->Get(path, headers);
+    release(std::move(client));
+    return res;
+}
+
+/**
+ * @brief Performs a GET request that is abandoned once the token is cancelled.
+ *
+ * A cancelled request fails with httplib::Error::Canceled, either before it
+ * is sent or while its body is being received.
+ *
+ * @param path Request path including the query string.
+ * @param headers Additional request headers.
+ * @param token Cancellation token of the request.
+ * @return The httplib result of the request.
+ */
+httplib::Result HostConnectionPool::Get(const std::string &path, const httplib::Headers &headers, const CancellationToken &token) {
+    if (token.cancelled()) {
+        return httplib::Result(nullptr, httplib::Error::Canceled);
+    }
+    std::unique_ptr<httplib::Client> client = acquire();
+    httplib::Result res = client->Get(path, headers, [&token](uint64_t, uint64_t) { return !token.cancelled(); });
+    release(std::move(client));
+    return res;
+}
+
+// Borrow an idle client, create a new one if under the limit, or wait for one to be returned
+std::unique_ptr<httplib::Client> HostConnectionPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    available.wait(lock, [this]() { return !idle.empty() || created < maxConnections; });
+
+    if (!idle.empty()) {
+        std::unique_ptr<httplib::Client> client = std::move(idle.back());
+        idle.pop_back();
+        return client;
+    }
+
+    created++;
+    lock.unlock();
+    auto client = std::make_unique<httplib::Client>(host, port);
+    client->set_keep_alive(true);// Reuse the connection for the next request
+    client->set_connection_timeout(5);
+    client->set_read_timeout(10);
+    return client;
+}
+
+// Return a client to the idle list and wake one waiting request
+void HostConnectionPool::release(std::unique_ptr<httplib::Client> client) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(client));
+    }
+    available.notify_one();
+}
+
@@ -0,0 +1,43 @@
+#ifndef HOST_CONNECTION_POOL_H
+#define HOST_CONNECTION_POOL_H
+
+#include "CancellationToken.h"
+#include <condition_variable>
+#include <httplib.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/**
+ * @class HostConnectionPool
+ * @brief A pool of keep-alive HTTP clients for a single host.
+ *
+ * httplib::Client is not safe to use from several threads at once, so every
+ * concurrent request borrows its own client from the pool and returns it when
+ * the request completes. Idle clients keep their connection open so later
+ * requests to the same host skip the TCP handshake.
+ */
+class HostConnectionPool {
+public:
+    HostConnectionPool(const std::string &host, int port, size_t maxConnections);
+
+    httplib::Result Get(const std::string &path);
+    httplib::Result Get(const std::string &path, const httplib::Headers &headers);
+    httplib::Result Get(const std::string &path, const httplib::Headers &headers, const CancellationToken &token);
+
+private:
+    std::unique_ptr<httplib::Client> acquire();
+    void release(std::unique_ptr<httplib::Client> client);
+
+    std::string host;
+    int port;
+    size_t maxConnections;
+    size_t created = 0;// Number of clients handed out or idle
+    std::vector<std::unique_ptr<httplib::Client>> idle;
+    std::mutex mutex;
+    std::condition_variable available;
+};
+
+#endif // HOST_CONNECTION_POOL_H
@@ -1,12 +1,23 @@
 #ifndef IMAGE_LOADER_H
 #define IMAGE_LOADER_H
 
-#include <winsock2.h>
+#ifdef _WIN32
+#include <winsock2.h>// Before windows.h, which GL/gl.h needs on Windows
 #include <windows.h>
+#endif
 #include <string>
+#include <vector>
 #include <GL/gl.h>
 
-bool DownloadImageFromURL(const std::string& imdbID, const std::string& savePath, const std::string& apiKey);
+// Decoded RGBA8 image, produced off the GL thread and uploaded later
+struct DecodedImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+bool DecodeImageFile(const std::string& filename, DecodedImage& image);
+GLuint UploadTexture(const DecodedImage& image);
 GLuint LoadTextureFromFile(const std::string& filename);
 
 #endif // IMAGE_LOADER_H
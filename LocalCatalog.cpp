@@ -0,0 +1,786 @@
+#include "LocalCatalog.h"
+#include "MovieJson.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+/*
+ * Index file layout, all integers little-endian as written by the host:
+ *
+ *   Header
+ *   MovieRecord[movieCount]          Ordered by vote count, most popular first
+ *   TermRecord[termCount]            Ordered by term bytes
+ *   uint32_t[postingCount]           Movie numbers, each term's list ascending
+ *   TrigramRecord[trigramCount]      Ordered by trigram
+ *   uint32_t[trigramPostingCount]    Term numbers, each trigram's list ascending
+ *   char[stringsSize]                Titles, years, genres and terms
+ */
+namespace {
+    const char kMagic[8] = {'M', 'F', 'C', 'A', 'T', 'L', '0', '2'};
+
+    struct Header {
+        char magic[8];
+        uint32_t movieCount;
+        uint32_t termCount;
+        uint64_t postingCount;
+        uint64_t stringsSize;
+        uint32_t trigramCount;
+        uint32_t reserved;
+        uint64_t trigramPostingCount;
+    };
+
+    const size_t kMinFuzzyLength = 4;  // Shorter words have too many near neighbours to correct
+    const size_t kMaxFuzzyLength = 64; // Longest word the distance kernel handles
+    const size_t kFuzzyTerms = 8;      // Corrections kept per misspelled word
+    const size_t kMaxScan = 200000;    // Candidate movies checked by one search at most
+
+    // Edits allowed when correcting a word of the given length
+    int maxEdits(size_t length) {
+        return length <= 5 ? 1 : 2;
+    }
+
+    // Distinct trigrams of a word padded with '$' at both ends, packed into the low 24 bits
+    std::vector<uint32_t> trigramsOf(std::string_view word) {
+        std::string padded = "$" + std::string(word) + "$";
+        std::vector<uint32_t> result;
+        for (size_t i = 0; i + 3 <= padded.size(); i++) {
+            result.push_back(uint32_t(uint8_t(padded[i])) << 16 | uint32_t(uint8_t(padded[i + 1])) << 8 | uint8_t(padded[i + 2]));
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    /*
+     * Levenshtein distance to a fixed pattern of up to 64 bytes, computed 64
+     * cells at a time with Myers' bit-vector algorithm (Hyyrö's formulation):
+     * one pass over the text with a handful of word operations per byte.
+     */
+    class BoundedDistance {
+    public:
+        explicit BoundedDistance(std::string_view pattern) : length(pattern.size()) {
+            for (size_t i = 0; i < pattern.size(); i++) {
+                peq[uint8_t(pattern[i])] |= uint64_t(1) << i;
+            }
+        }
+
+        // The distance to text, or maxDistance + 1 if it is larger
+        int operator()(std::string_view text, int maxDistance) const {
+            uint64_t positive = ~uint64_t(0);// Vertical deltas of +1
+            uint64_t negative = 0;           // Vertical deltas of -1
+            uint64_t last = uint64_t(1) << (length - 1);
+            int score = static_cast<int>(length);
+            for (size_t j = 0; j < text.size(); j++) {
+                uint64_t eq = peq[uint8_t(text[j])];
+                uint64_t xv = eq | negative;
+                uint64_t xh = (((eq & positive) + positive) ^ positive) | eq;
+                uint64_t hp = negative | ~(xh | positive);
+                uint64_t hn = positive & xh;
+                if (hp & last) score++;
+                else if (hn & last) score--;
+                // The rest of the text can lower the score by at most one per byte
+                if (score - static_cast<int>(text.size() - j - 1) > maxDistance) {
+                    return maxDistance + 1;
+                }
+                hp = (hp << 1) | 1;
+                hn <<= 1;
+                positive = hn | ~(xv | hp);
+                negative = hp & xv;
+            }
+            return std::min(score, maxDistance + 1);
+        }
+
+    private:
+        uint64_t peq[256] = {};// Bit i of peq[c] is set if pattern[i] == c
+        size_t length;
+    };
+
+    // "\N" marks an empty field in the IMDb dumps
+    const std::string kNull = "\\N";
+
+    // Title types that OMDb also lists; episodes make up most of the dump and are left out
+    bool isListedType(const std::string &titleType) {
+        return titleType != "tvEpisode" && titleType != "videoGame" && titleType != "tvPilot";
+    }
+
+    std::vector<std::string> splitTabs(const std::string &line) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab - start));
+            if (tab == std::string::npos) break;
+            start = tab + 1;
+        }
+        return fields;
+    }
+
+    // ASCII spelling of U+00C0..U+00FF; an empty entry separates words
+    const char *const kLatin1Fold[64] = {
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+            "d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "ss",
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+            "d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "y"};
+
+    // ASCII spelling of U+0100..U+017F (Latin Extended-A), by the first code point of each run
+    struct FoldRun {
+        uint32_t first;
+        const char *ascii;
+    };
+    const FoldRun kExtendedAFold[] = {
+            {0x100, "a"}, {0x106, "c"}, {0x10E, "d"}, {0x112, "e"}, {0x11C, "g"}, {0x124, "h"}, {0x128, "i"},
+            {0x132, "ij"}, {0x134, "j"}, {0x136, "k"}, {0x139, "l"}, {0x143, "n"}, {0x14C, "o"}, {0x152, "oe"},
+            {0x154, "r"}, {0x15A, "s"}, {0x162, "t"}, {0x168, "u"}, {0x174, "w"}, {0x176, "y"}, {0x179, "z"},
+            {0x17F, "s"}};
+
+    // Returns the folded spelling of a code point, "" for a word separator, or nullptr to keep it as is
+    const char *foldCodePoint(uint32_t codePoint) {
+        if (codePoint < 0xC0) return "";// Latin-1 punctuation and symbols
+        if (codePoint < 0x100) return kLatin1Fold[codePoint - 0xC0];
+        if (codePoint < 0x180) {
+            const char *ascii = kExtendedAFold[0].ascii;
+            for (const FoldRun &run: kExtendedAFold) {
+                if (run.first > codePoint) break;
+                ascii = run.ascii;
+            }
+            return ascii;
+        }
+        if (codePoint >= 0x2000 && codePoint < 0x2070) return "";// General punctuation: dashes, quotes, ellipsis
+        return nullptr;
+    }
+
+    // Decodes the UTF-8 sequence at text[i]; returns its length, or 0 if it is malformed
+    size_t decodeUtf8(const std::string &text, size_t i, uint32_t &codePoint) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+        if (length == 0 || i + length > text.size()) return 0;
+        codePoint = lead & (0x7F >> length);
+        for (size_t k = 1; k < length; k++) {
+            unsigned char next = static_cast<unsigned char>(text[i + k]);
+            if ((next & 0xC0) != 0x80) return 0;
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+        return length;
+    }
+
+    // Movie as read from the dumps, before it is numbered and written
+    struct Title {
+        std::string imdbID;
+        std::string title;
+        std::string originalTitle;// Empty if it is the same as title
+        std::string year;
+        std::string genre;
+        std::string imdbRating;
+        float rating = -1.0f;
+        int releaseYear = 0;
+        uint32_t votes = 0;
+    };
+}// namespace
+
+struct LocalCatalog::MovieRecord {
+    uint32_t stringOffset;// imdbID, title, original title, year, genre and rating, back to back
+    uint16_t idSize;
+    uint16_t titleSize;
+    uint16_t originalTitleSize;
+    uint16_t yearSize;
+    uint16_t genreSize;
+    uint16_t ratingSize;
+    float rating;
+    int32_t releaseYear;
+    uint32_t votes;
+};
+
+struct LocalCatalog::TermRecord {
+    uint32_t stringOffset;
+    uint32_t size;
+    uint32_t postingOffset;// Index of the first movie number in the postings
+    uint32_t postingCount;
+};
+
+struct LocalCatalog::TrigramRecord {
+    uint32_t trigram;
+    uint32_t postingOffset;// Index of the first term number in the trigram postings
+    uint32_t postingCount;
+};
+
+
+/**
+ * @brief Memory-maps an index written by build().
+ *
+ * @param indexPath Path of the index file.
+ * @return true if the index was opened, false if it is missing or malformed.
+ */
+bool LocalCatalog::open(const std::string &indexPath) {
+    movieCount = 0;
+    if (!mapped.open(indexPath)) {
+        return false;
+    }
+
+    Header header;
+    if (mapped.size() < sizeof(header)) {
+        std::cerr << "ERROR: Movie catalog " << indexPath << " is truncated" << std::endl;
+        mapped.close();
+        return false;
+    }
+    std::memcpy(&header, mapped.data(), sizeof(header));
+    uint64_t expectedSize = sizeof(header) + uint64_t(header.movieCount) * sizeof(MovieRecord) +
+                            uint64_t(header.termCount) * sizeof(TermRecord) + header.postingCount * sizeof(uint32_t) +
+                            uint64_t(header.trigramCount) * sizeof(TrigramRecord) +
+                            header.trigramPostingCount * sizeof(uint32_t) + header.stringsSize;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || expectedSize != mapped.size()) {
+        std::cerr << "ERROR: " << indexPath << " is not a movie catalog of this version" << std::endl;
+        mapped.close();
+        return false;
+    }
+
+    const char *section = mapped.data() + sizeof(header);
+    movies = reinterpret_cast<const MovieRecord *>(section);
+    section += header.movieCount * sizeof(MovieRecord);
+    terms = reinterpret_cast<const TermRecord *>(section);
+    section += header.termCount * sizeof(TermRecord);
+    postings = reinterpret_cast<const uint32_t *>(section);
+    section += header.postingCount * sizeof(uint32_t);
+    trigrams = reinterpret_cast<const TrigramRecord *>(section);
+    section += header.trigramCount * sizeof(TrigramRecord);
+    trigramPostings = reinterpret_cast<const uint32_t *>(section);
+    section += header.trigramPostingCount * sizeof(uint32_t);
+    strings = section;
+
+    termCount = header.termCount;
+    postingCount = header.postingCount;
+    trigramCount = header.trigramCount;
+    trigramPostingCount = header.trigramPostingCount;
+    stringsSize = header.stringsSize;
+    movieCount = header.movieCount;
+    std::cout << " Movie catalog: " << movieCount << " movies, " << termCount << " terms" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Finds the movies whose title contains every word of the query.
+ *
+ * The last word also matches longer words it is a prefix of, so "star wa"
+ * finds "Star Wars" while the user is still typing. Results are ordered by
+ * popularity.
+ *
+ * @param query The search query string.
+ * @param limit Maximum number of movies to return.
+ * @param prefix Match the last word as a prefix.
+ * @return The matching movies with title, year, IMDb ID, genre and rating filled in.
+ */
+std::vector<Movie> LocalCatalog::search(const std::string &query, size_t limit, bool prefix) const {
+    std::vector<std::string> tokens = tokenize(query);
+    if (!isOpen() || tokens.empty() || limit == 0) {
+        return {};
+    }
+    std::vector<WordMatch> words(tokens.size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        words[i].token = std::move(tokens[i]);
+        words[i].prefix = prefix && i + 1 == words.size();
+        if (!matchDirectly(words[i])) {
+            return {};// Some word matches no title at all
+        }
+    }
+    return collect(words, limit);
+}
+
+/**
+ * @brief Finds the movies whose title contains every word of the query, allowing typos.
+ *
+ * Words that match no title are replaced by the closest known spellings
+ * within one edit (words up to 5 letters) or two edits (longer words).
+ * Results are ordered by the total number of edits, then by popularity.
+ * The last word is still matched as a prefix when it is spelled correctly.
+ *
+ * @param query The search query string.
+ * @param limit Maximum number of movies to return.
+ * @return The matching movies with title, year, IMDb ID, genre and rating filled in.
+ */
+std::vector<Movie> LocalCatalog::searchFuzzy(const std::string &query, size_t limit) const {
+    std::vector<std::string> tokens = tokenize(query);
+    if (!isOpen() || tokens.empty() || limit == 0) {
+        return {};
+    }
+    std::vector<WordMatch> words(tokens.size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        words[i].token = std::move(tokens[i]);
+        words[i].prefix = i + 1 == words.size();
+        if (!matchDirectly(words[i]) && !matchFuzzy(words[i])) {
+            return {};
+        }
+    }
+    return collect(words, limit);
+}
+
+/**
+ * @brief Builds an index file from the IMDb dataset dumps.
+ *
+ * Episodes, video games and adult titles are left out. The index is written
+ * to a temporary file and renamed into place.
+ *
+ * @param basicsPath Path of title.basics.tsv.
+ * @param ratingsPath Path of title.ratings.tsv, or empty to index without ratings.
+ * @param indexPath Path of the index file to write.
+ * @return true if the index was written.
+ */
+bool LocalCatalog::build(const std::string &basicsPath, const std::string &ratingsPath, const std::string &indexPath) {
+    // Ratings by IMDb number: "tconst averageRating numVotes"
+    std::unordered_map<int, std::pair<std::string, uint32_t>> ratings;
+    if (!ratingsPath.empty()) {
+        std::ifstream in(ratingsPath);
+        if (!in) {
+            std::cerr << "ERROR: Could not open " << ratingsPath << std::endl;
+            return false;
+        }
+        std::string line;
+        std::getline(in, line);// Column names
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields = splitTabs(line);
+            if (fields.size() >= 3) {
+                ratings[ParseImdbNumber(fields[0])] = {fields[1], static_cast<uint32_t>(std::strtoul(fields[2].c_str(), nullptr, 10))};
+            }
+        }
+    }
+
+    // Titles: "tconst titleType primaryTitle originalTitle isAdult startYear endYear runtimeMinutes genres"
+    std::ifstream in(basicsPath);
+    if (!in) {
+        std::cerr << "ERROR: Could not open " << basicsPath << std::endl;
+        return false;
+    }
+    std::vector<Title> titles;
+    std::string line;
+    std::getline(in, line);// Column names
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields = splitTabs(line);
+        if (fields.size() < 9 || !isListedType(fields[1]) || fields[4] == "1") {
+            continue;
+        }
+        Title title;
+        title.imdbID = fields[0];
+        title.title = fields[2];
+        if (fields[3] != fields[2] && fields[3] != kNull) {
+            title.originalTitle = fields[3];
+        }
+        // Same shape as OMDb's year: "1999", "2008–2013" or "2019–" for a running series
+        if (fields[5] != kNull) {
+            title.year = fields[5];
+            if (fields[6] != kNull) {
+                title.year += "\xe2\x80\x93" + fields[6];
+            } else if (fields[1] == "tvSeries") {
+                title.year += "\xe2\x80\x93";
+            }
+        } else {
+            title.year = "N/A";
+        }
+        title.releaseYear = ParseReleaseYear(title.year);
+        // "Action,Drama" is listed as "Action, Drama" by OMDb
+        title.genre = fields[8] == kNull ? "N/A" : fields[8];
+        for (size_t comma = title.genre.find(','); comma != std::string::npos; comma = title.genre.find(',', comma + 2)) {
+            title.genre.insert(comma + 1, " ");
+        }
+        auto rating = ratings.find(ParseImdbNumber(title.imdbID));
+        if (rating != ratings.end()) {
+            title.imdbRating = rating->second.first;
+            title.rating = ParseImdbRating(title.imdbRating);
+            title.votes = rating->second.second;
+        } else {
+            title.imdbRating = "N/A";
+        }
+        titles.push_back(std::move(title));
+    }
+    ratings.clear();
+
+    // Number the movies by popularity, so posting lists come out in ranking order
+    std::stable_sort(titles.begin(), titles.end(), [](const Title &a, const Title &b) { return a.votes > b.votes; });
+
+    std::string stringData;
+    std::vector<MovieRecord> movieRecords;
+    movieRecords.reserve(titles.size());
+    std::unordered_map<std::string, std::vector<uint32_t>> termPostings;
+    auto clampSize = [](const std::string &value) { return static_cast<uint16_t>(std::min<size_t>(value.size(), UINT16_MAX)); };
+    for (uint32_t number = 0; number < titles.size(); number++) {
+        const Title &title = titles[number];
+        MovieRecord record{};
+        record.stringOffset = static_cast<uint32_t>(stringData.size());
+        record.idSize = clampSize(title.imdbID);
+        record.titleSize = clampSize(title.title);
+        record.originalTitleSize = clampSize(title.originalTitle);
+        record.yearSize = clampSize(title.year);
+        record.genreSize = clampSize(title.genre);
+        record.ratingSize = clampSize(title.imdbRating);
+        record.rating = title.rating;
+        record.releaseYear = title.releaseYear;
+        record.votes = title.votes;
+        stringData.append(title.imdbID, 0, record.idSize);
+        stringData.append(title.title, 0, record.titleSize);
+        stringData.append(title.originalTitle, 0, record.originalTitleSize);
+        stringData.append(title.year, 0, record.yearSize);
+        stringData.append(title.genre, 0, record.genreSize);
+        stringData.append(title.imdbRating, 0, record.ratingSize);
+        movieRecords.push_back(record);
+
+        for (const std::string &token: tokenize(title.title + " " + title.originalTitle)) {
+            std::vector<uint32_t> &list = termPostings[token];
+            if (list.empty() || list.back() != number) {
+                list.push_back(number);
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, std::vector<uint32_t>>> sortedTerms(
+            std::make_move_iterator(termPostings.begin()), std::make_move_iterator(termPostings.end()));
+    termPostings.clear();
+    std::sort(sortedTerms.begin(), sortedTerms.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    std::vector<TermRecord> termRecords;
+    std::vector<uint32_t> postingData;
+    termRecords.reserve(sortedTerms.size());
+    for (const auto &[term, list]: sortedTerms) {
+        termRecords.push_back({static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(term.size()),
+                               static_cast<uint32_t>(postingData.size()), static_cast<uint32_t>(list.size())});
+        stringData += term;
+        postingData.insert(postingData.end(), list.begin(), list.end());
+    }
+    sortedTerms.clear();
+
+    // List every term under each of its trigrams, for typo-tolerant searches
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigramTerms;
+    for (uint32_t number = 0; number < termRecords.size(); number++) {
+        std::string_view term(stringData.data() + termRecords[number].stringOffset, termRecords[number].size);
+        for (uint32_t trigram: trigramsOf(term)) {
+            trigramTerms[trigram].push_back(number);
+        }
+    }
+    std::vector<TrigramRecord> trigramRecords;
+    std::vector<uint32_t> trigramData;
+    trigramRecords.reserve(trigramTerms.size());
+    for (auto &[trigram, list]: trigramTerms) {
+        trigramRecords.push_back({trigram, static_cast<uint32_t>(trigramData.size()), static_cast<uint32_t>(list.size())});
+        trigramData.insert(trigramData.end(), list.begin(), list.end());
+    }
+    trigramTerms.clear();
+    std::sort(trigramRecords.begin(), trigramRecords.end(), [](const TrigramRecord &a, const TrigramRecord &b) { return a.trigram < b.trigram; });
+
+    if (stringData.size() > UINT32_MAX || postingData.size() > UINT32_MAX || trigramData.size() > UINT32_MAX) {
+        std::cerr << "ERROR: Movie catalog is too large for the index format" << std::endl;
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.movieCount = static_cast<uint32_t>(movieRecords.size());
+    header.termCount = static_cast<uint32_t>(termRecords.size());
+    header.postingCount = postingData.size();
+    header.stringsSize = stringData.size();
+    header.trigramCount = static_cast<uint32_t>(trigramRecords.size());
+    header.trigramPostingCount = trigramData.size();
+
+    std::string tempPath = indexPath + ".part";
+    std::FILE *out = std::fopen(tempPath.c_str(), "wb");
+    bool written = out != nullptr &&
+                   std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+                   std::fwrite(movieRecords.data(), sizeof(MovieRecord), movieRecords.size(), out) == movieRecords.size() &&
+                   std::fwrite(termRecords.data(), sizeof(TermRecord), termRecords.size(), out) == termRecords.size() &&
+                   std::fwrite(postingData.data(), sizeof(uint32_t), postingData.size(), out) == postingData.size() &&
+                   std::fwrite(trigramRecords.data(), sizeof(TrigramRecord), trigramRecords.size(), out) == trigramRecords.size() &&
+                   std::fwrite(trigramData.data(), sizeof(uint32_t), trigramData.size(), out) == trigramData.size() &&
+                   std::fwrite(stringData.data(), 1, stringData.size(), out) == stringData.size();
+    if (out) {
+        written = std::fclose(out) == 0 && written;
+    }
+    std::error_code ec;
+    if (written) {
+        fs::rename(tempPath, indexPath, ec);
+    }
+    if (!written || ec) {
+        std::cerr << "ERROR: Could not write movie catalog " << indexPath << std::endl;
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    std::cout << " Movie catalog: indexed " << movieRecords.size() << " movies, " << termRecords.size() << " terms" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Splits text into search terms.
+ *
+ * Terms are lower case and stripped of Latin accents ("Amélie" becomes
+ * "amelie"). Apostrophes are dropped rather than splitting a word, so
+ * "Schindler's" becomes "schindlers". Letters of other scripts are kept as
+ * they are.
+ *
+ * @param text A title or a search query.
+ * @return The terms in order of appearance.
+ */
+std::vector<std::string> LocalCatalog::tokenize(const std::string &text) {
+    std::vector<std::string> tokens;
+    std::string current;
+    auto endWord = [&]() {
+        if (!current.empty()) {
+            tokens.push_back(std::move(current));
+            current.clear();
+        }
+    };
+
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            if (std::isalnum(c)) {
+                current += static_cast<char>(std::tolower(c));
+            } else if (c != '\'') {
+                endWord();
+            }
+            i++;
+            continue;
+        }
+
+        uint32_t codePoint = 0;
+        size_t length = decodeUtf8(text, i, codePoint);
+        if (length == 0) {
+            endWord();// Not UTF-8
+            i++;
+            continue;
+        }
+        if (codePoint == 0x2018 || codePoint == 0x2019) {
+            // Typographic apostrophe, part of the word
+        } else if (const char *folded = foldCodePoint(codePoint)) {
+            if (*folded) {
+                current += folded;
+            } else {
+                endWord();
+            }
+        } else {
+            current.append(text, i, length);
+        }
+        i += length;
+    }
+    endWord();
+    return tokens;
+}
+
+// Collect the terms equal to the word, or starting with it for a prefix; false if there are none
+bool LocalCatalog::matchDirectly(WordMatch &word) const {
+    const TermRecord *end = terms + termCount;
+    const TermRecord *first = std::lower_bound(terms, end, word.token, [this](const TermRecord &term, const std::string &value) {
+        return termAt(term) < value;
+    });
+    const TermRecord *last = first;
+    if (word.prefix) {
+        last = std::partition_point(first, end, [this, &word](const TermRecord &term) {
+            return termAt(term).starts_with(word.token);
+        });
+    } else if (first != end && termAt(*first) == word.token) {
+        last = first + 1;
+    }
+    for (const TermRecord *term = first; term != last; term++) {
+        if (uint64_t(term->postingOffset) + term->postingCount > postingCount) {
+            return false;// Corrupt index
+        }
+        word.terms.push_back(term);
+        word.postings += term->postingCount;
+    }
+    return !word.terms.empty();
+}
+
+// Collect the closest spellings of a word that matches no term; false if there are none
+bool LocalCatalog::matchFuzzy(WordMatch &word) const {
+    if (word.token.size() < kMinFuzzyLength || word.token.size() > kMaxFuzzyLength || trigramCount == 0) {
+        return false;
+    }
+    int edits = maxEdits(word.token.size());
+    std::vector<uint32_t> grams = trigramsOf(word.token);
+    // Each edit destroys at most three trigrams, so a match shares at least this many
+    int minShared = std::max(1, static_cast<int>(grams.size()) - 3 * edits);
+
+    // Count the trigrams each term shares with the word
+    std::vector<uint8_t> shared(termCount, 0);
+    std::vector<uint32_t> candidates;
+    const TrigramRecord *end = trigrams + trigramCount;
+    for (uint32_t gram: grams) {
+        const TrigramRecord *record = std::lower_bound(trigrams, end, gram, [](const TrigramRecord &entry, uint32_t value) {
+            return entry.trigram < value;
+        });
+        if (record == end || record->trigram != gram ||
+            uint64_t(record->postingOffset) + record->postingCount > trigramPostingCount) {
+            continue;
+        }
+        for (uint32_t i = 0; i < record->postingCount; i++) {
+            uint32_t term = trigramPostings[record->postingOffset + i];
+            if (term < termCount && shared[term]++ == 0) {
+                candidates.push_back(term);
+            }
+        }
+    }
+
+    // Compare the promising terms letter by letter
+    struct Correction {
+        int distance;
+        uint32_t postings;
+        const TermRecord *term;
+    };
+    std::vector<Correction> corrections;
+    BoundedDistance distance(word.token);
+    for (uint32_t number: candidates) {
+        if (shared[number] < minShared) {
+            continue;
+        }
+        const TermRecord &term = terms[number];
+        std::string_view text = termAt(term);
+        if (std::abs(static_cast<int>(text.size()) - static_cast<int>(word.token.size())) > edits) {
+            continue;
+        }
+        int d = distance(text, edits);
+        if (d <= edits && uint64_t(term.postingOffset) + term.postingCount <= postingCount) {
+            corrections.push_back({d, term.postingCount, &term});
+        }
+    }
+
+    // Keep the closest spellings, the most common first
+    size_t keep = std::min(corrections.size(), kFuzzyTerms);
+    std::partial_sort(corrections.begin(), corrections.begin() + keep, corrections.end(), [](const Correction &a, const Correction &b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.postings > b.postings;
+    });
+    for (size_t i = 0; i < keep; i++) {
+        word.terms.push_back(corrections[i].term);
+        word.corrected.emplace_back(termAt(*corrections[i].term), corrections[i].distance);
+        word.postings += corrections[i].postings;
+    }
+    return keep > 0;
+}
+
+// Walk the posting lists of the rarest word in ranking order and check the other words against each title
+std::vector<Movie> LocalCatalog::collect(const std::vector<WordMatch> &words, size_t limit) const {
+    const WordMatch *driver = &words[0];
+    int bestCost = 0;// Lowest possible total of edits
+    for (const WordMatch &word: words) {
+        if (word.postings < driver->postings) {
+            driver = &word;
+        }
+        if (!word.corrected.empty()) {
+            bestCost += word.corrected.front().second;
+        }
+    }
+
+    // Merge the driver's posting lists (several for a prefix or correction) in ascending, i.e. ranking, order
+    struct Cursor {
+        uint32_t movie;   // Movie number at position
+        uint32_t position;// Position in the postings
+        uint32_t end;     // End of the posting list
+        bool operator>(const Cursor &other) const { return movie > other.movie; }
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<>> heap;
+    for (const TermRecord *term: driver->terms) {
+        if (term->postingCount > 0) {
+            heap.push({postings[term->postingOffset], term->postingOffset, term->postingOffset + term->postingCount});
+        }
+    }
+
+    std::vector<std::pair<int, uint32_t>> matches;// Total edits and movie number
+    size_t bestMatches = 0;                       // Matches with the lowest possible total
+    size_t scanned = 0;
+    int64_t last = -1;
+    // Stop once enough movies need no more edits than any other could; later ones are less popular
+    while (!heap.empty() && bestMatches < limit && scanned < kMaxScan) {
+        Cursor cursor = heap.top();
+        heap.pop();
+        uint32_t movie = cursor.movie;
+        if (++cursor.position < cursor.end) {
+            cursor.movie = postings[cursor.position];
+            heap.push(cursor);
+        }
+
+        if (movie == last || movie >= movieCount) {
+            continue;// Listed under two terms of the driver, or a corrupt posting
+        }
+        last = movie;
+        scanned++;
+        int cost = titleCost(movie, words);
+        if (cost >= 0) {
+            matches.emplace_back(cost, movie);
+            bestMatches += cost == bestCost;
+        }
+    }
+
+    // Fewest edits first; movie numbers are already in popularity order
+    std::stable_sort(matches.begin(), matches.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    std::vector<Movie> result;
+    for (size_t i = 0; i < matches.size() && i < limit; i++) {
+        result.push_back(movieAt(matches[i].second));
+    }
+    return result;
+}
+
+// Total edits needed to match every query word against the movie's title or original title, or -1 if some word does not match
+int LocalCatalog::titleCost(uint32_t index, const std::vector<WordMatch> &words) const {
+    const MovieRecord &record = movies[index];
+    std::string_view title = stringAt(record.stringOffset + record.idSize, record.titleSize);
+    std::string_view originalTitle = stringAt(record.stringOffset + record.idSize + record.titleSize, record.originalTitleSize);
+    std::vector<std::string> titleWords = tokenize(std::string(title) + " " + std::string(originalTitle));
+
+    int total = 0;
+    for (const WordMatch &word: words) {
+        int best = -1;
+        for (const std::string &titleWord: titleWords) {
+            if (word.corrected.empty()) {
+                if (word.prefix ? titleWord.starts_with(word.token) : titleWord == word.token) {
+                    best = 0;
+                    break;
+                }
+                continue;
+            }
+            for (const auto &[spelling, distance]: word.corrected) {
+                if (titleWord == spelling && (best < 0 || distance < best)) {
+                    best = distance;
+                }
+            }
+        }
+        if (best < 0) {
+            return -1;
+        }
+        total += best;
+    }
+    return total;
+}
+
+std::string_view LocalCatalog::termAt(const TermRecord &term) const {
+    return stringAt(term.stringOffset, term.size);
+}
+
+// A string from the strings section, empty if it lies outside it
+std::string_view LocalCatalog::stringAt(uint32_t offset, uint32_t size) const {
+    if (uint64_t(offset) + size > stringsSize) {
+        return {};
+    }
+    return std::string_view(strings + offset, size);
+}
+
+Movie LocalCatalog::movieAt(uint32_t index) const {
+    const MovieRecord &record = movies[index];
+    uint32_t offset = record.stringOffset;
+    auto next = [&](uint16_t size) {
+        std::string_view value = stringAt(offset, size);
+        offset += size;
+        return std::string(value);
+    };
+    Movie movie;
+    movie.imdbID = next(record.idSize);
+    movie.title = next(record.titleSize);
+    offset += record.originalTitleSize;
+    movie.year = next(record.yearSize);
+    movie.genre = next(record.genreSize);
+    movie.imdbRating = next(record.ratingSize);
+    movie.rating = record.rating;
+    movie.releaseYear = record.releaseYear;
+    return movie;
+}
@@ -0,0 +1,92 @@
+#ifndef LOCAL_CATALOG_H
+#define LOCAL_CATALOG_H
+
+#include "MappedFile.h"
+#include "Movie.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * @class LocalCatalog
+ * @brief An offline movie catalog searched through an on-disk inverted index.
+ *
+ * build() ingests the IMDb dataset dumps (title.basics.tsv and, optionally,
+ * title.ratings.tsv) into a single index file. open() memory-maps the file,
+ * so searches read straight from the page cache without loading it.
+ *
+ * Titles are split into terms that are case-folded and stripped of accents,
+ * so "Amélie" is found by "amelie". Each term has a posting list of the
+ * movies whose title contains it. Movies are numbered by popularity (IMDb
+ * vote count) when the index is built, so posting lists are in ranking order
+ * and a search can stop as soon as it has enough results. Terms are stored
+ * sorted, which lets the last word of a query match as a prefix for
+ * search-as-you-type.
+ *
+ * searchFuzzy() tolerates typos such as "interstelar" or "godfathr". Every
+ * term is also listed under its trigrams; a misspelled word collects the
+ * terms sharing enough trigrams with it, and only those are compared with a
+ * bit-parallel edit distance bounded by one or two edits.
+ *
+ * A catalog is read-only once opened, so search() and searchFuzzy() may be
+ * called from any thread.
+ */
+class LocalCatalog {
+public:
+    LocalCatalog() = default;
+
+    LocalCatalog(const LocalCatalog &) = delete;
+    LocalCatalog &operator=(const LocalCatalog &) = delete;
+
+    bool open(const std::string &indexPath);
+    bool isOpen() const { return movieCount > 0; }
+    size_t size() const { return movieCount; }
+
+    std::vector<Movie> search(const std::string &query, size_t limit, bool prefix = true) const;
+    std::vector<Movie> searchFuzzy(const std::string &query, size_t limit) const;
+
+    static bool build(const std::string &basicsPath, const std::string &ratingsPath, const std::string &indexPath);
+    static std::vector<std::string> tokenize(const std::string &text);
+
+    // On-disk layout, see LocalCatalog.cpp
+    struct MovieRecord;
+    struct TermRecord;
+    struct TrigramRecord;
+
+private:
+    // How one query word is matched: directly, or through spelling corrections
+    struct WordMatch {
+        std::string token;
+        bool prefix = false;
+        std::vector<const TermRecord *> terms;                  // Terms whose posting lists contain the matches
+        std::vector<std::pair<std::string_view, int>> corrected;// Corrected spellings and their edit distance, empty if matched directly
+        uint64_t postings = 0;                                  // Total length of the posting lists
+    };
+
+    bool matchDirectly(WordMatch &word) const;
+    bool matchFuzzy(WordMatch &word) const;
+    std::vector<Movie> collect(const std::vector<WordMatch> &words, size_t limit) const;
+    int titleCost(uint32_t index, const std::vector<WordMatch> &words) const;
+    std::string_view termAt(const TermRecord &term) const;
+    std::string_view stringAt(uint32_t offset, uint32_t size) const;
+    Movie movieAt(uint32_t index) const;
+
+    MappedFile mapped;
+    const MovieRecord *movies = nullptr;
+    const TermRecord *terms = nullptr;
+    const uint32_t *postings = nullptr;
+    const TrigramRecord *trigrams = nullptr;
+    const uint32_t *trigramPostings = nullptr;// Term numbers, each trigram's list ascending
+    const char *strings = nullptr;
+    size_t movieCount = 0;
+    size_t termCount = 0;
+    size_t postingCount = 0;
+    size_t trigramCount = 0;
+    size_t trigramPostingCount = 0;
+    size_t stringsSize = 0;
+};
+
+#endif // LOCAL_CATALOG_H
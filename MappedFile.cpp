@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * @brief Maps the whole file into memory, replacing any previous mapping.
+ *
+ * An empty file is opened successfully with a null data pointer.
+ *
+ * @param path Path of the file to map.
+ * @return true if the file was mapped, false if it could not be opened.
+ */
+bool MappedFile::open(const std::string &path) {
+    close();
+#ifdef _WIN32
+    // Share everything so the file can still be appended to and replaced while mapped
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return true;
+    }
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);// The mapping keeps the file open
+    if (!mapping) {
+        return false;
+    }
+    view = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!view) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void *address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);// The mapping keeps the file open
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    view = static_cast<const char *>(address);
+    length = static_cast<size_t>(info.st_size);
+#endif
+    return true;
+}
+
+/**
+ * @brief Releases the mapping.
+ */
+void MappedFile::close() {
+#ifdef _WIN32
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (view) munmap(const_cast<char *>(view), length);
+#endif
+    view = nullptr;
+    length = 0;
+}
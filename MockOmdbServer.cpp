@@ -0,0 +1,122 @@
+#include "MockOmdbServer.h"
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <vector>
+// JSON alias
+using json = nlohmann::json;
+
+
+// Fake IMDb ID of the index-th movie of a query's results, stable across runs
+static std::string fakeImdbID(const std::string &query, int index) {
+    uint64_t number = (std::hash<std::string>{}(query) % 9000000) * 100 + static_cast<uint64_t>(index);
+    return "tt" + std::to_string(number);
+}
+
+/**
+ * @brief Sets up the routes; nothing is served until start().
+ *
+ * @param latency Delay before every response, e.g. a typical round trip to OMDb.
+ * @param threadCount Number of requests held back at the same time per server.
+ */
+MockOmdbServer::MockOmdbServer(std::chrono::milliseconds latency, size_t threadCount) : latency(latency) {
+    apiServer.new_task_queue = [threadCount]() { return new httplib::ThreadPool(threadCount); };
+    imageServer.new_task_queue = [threadCount]() { return new httplib::ThreadPool(threadCount); };
+    apiServer.Get("/", [this](const httplib::Request &request, httplib::Response &response) {
+        handleApi(request, response);
+    });
+    imageServer.Get("/", [this](const httplib::Request &request, httplib::Response &response) {
+        handlePoster(request, response);
+    });
+}
+
+MockOmdbServer::~MockOmdbServer() {
+    stop();
+}
+
+/**
+ * @brief Binds both servers to free ports and serves them in the background.
+ *
+ * @param host Address to listen on.
+ * @return false if a port could not be bound.
+ */
+bool MockOmdbServer::start(const std::string &host) {
+    this->host = host;
+    apiPort = apiServer.bind_to_any_port(host);
+    imagePort = imageServer.bind_to_any_port(host);
+    if (apiPort <= 0 || imagePort <= 0) {
+        std::cerr << "ERROR: Failed to bind the mock OMDb server to " << host << std::endl;
+        return false;
+    }
+    apiThread = std::thread([this]() { apiServer.listen_after_bind(); });
+    imageThread = std::thread([this]() { imageServer.listen_after_bind(); });
+    return true;
+}
+
+/**
+ * @brief Stops both servers and waits for their threads.
+ */
+void MockOmdbServer::stop() {
+    apiServer.stop();
+    imageServer.stop();
+    if (apiThread.joinable()) apiThread.join();
+    if (imageThread.joinable()) imageThread.join();
+}
+
+/**
+ * @brief Returns the hosts to pass to OMDbApi so it talks to this server.
+ */
+OMDbHosts MockOmdbServer::hosts() const {
+    OMDbHosts hosts;
+    hosts.api = host;
+    hosts.apiPort = apiPort;
+    hosts.image = host;
+    hosts.imagePort = imagePort;
+    return hosts;
+}
+
+// GET /?apikey=<key>&s=<query>&page=<n> or /?apikey=<key>&i=<IMDb ID>
+void MockOmdbServer::handleApi(const httplib::Request &request, httplib::Response &response) {
+    requestCount++;
+    std::this_thread::sleep_for(latency);
+
+    if (request.has_param("s")) {
+        std::string query = request.get_param_value("s");
+        int page = request.has_param("page") ? std::atoi(request.get_param_value("page").c_str()) : 1;
+        json results = json::array();
+        for (int i = 0; i < kPageSize; i++) {
+            int index = (page - 1) * kPageSize + i;
+            results.push_back({{"Title", query + " " + std::to_string(index + 1)},
+                               {"Year", std::to_string(1980 + index % 40)},
+                               {"imdbID", fakeImdbID(query, index)},
+                               {"Type", "movie"},
+                               {"Poster", "https://m.media-amazon.com/images/M/mock.jpg"}});
+        }
+        json body = {{"Search", results}, {"totalResults", "100"}, {"Response", "True"}};
+        response.set_content(body.dump(), "application/json");
+    } else if (request.has_param("i")) {
+        std::string imdbID = request.get_param_value("i");
+        json body = {{"Title", "Mock " + imdbID},
+                     {"Year", "1999"},
+                     {"Genre", "Drama, Mystery"},
+                     {"imdbRating", "7.5"},
+                     {"imdbID", imdbID},
+                     {"Poster", "https://m.media-amazon.com/images/M/mock.jpg"},
+                     {"Response", "True"}};
+        response.set_content(body.dump(), "application/json");
+    } else {
+        response.set_content(R"({"Response":"False","Error":"Incorrect IMDb ID."})", "application/json");
+    }
+}
+
+// GET /?apikey=<key>&i=<IMDb ID> on the image port; a small fake poster
+void MockOmdbServer::handlePoster(const httplib::Request &request, httplib::Response &response) {
+    requestCount++;
+    std::this_thread::sleep_for(latency);
+
+    std::string poster(16 * 1024, '\0');// About the size of an OMDb poster thumbnail
+    std::string imdbID = request.get_param_value("i");
+    poster.replace(0, imdbID.size(), imdbID);
+    response.set_content(poster, "image/jpeg");
+}
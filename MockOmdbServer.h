@@ -0,0 +1,55 @@
+#ifndef MOCK_OMDB_SERVER_H
+#define MOCK_OMDB_SERVER_H
+
+#include "OMDbApi.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <httplib.h>
+#include <string>
+#include <thread>
+
+
+/**
+ * @class MockOmdbServer
+ * @brief A local stand-in for the OMDb API and poster servers that answers after a fixed delay.
+ *
+ * Serves "&s=" searches, "&i=" details and posters on two local ports, like
+ * www.omdbapi.com and img.omdbapi.com. Every response is held back by the
+ * configured latency, so benchmarks see the round trips they would see
+ * against OMDb without using the API quota. Search results get IMDb IDs
+ * derived from the query, so a new query misses every cache.
+ */
+class MockOmdbServer {
+public:
+    explicit MockOmdbServer(std::chrono::milliseconds latency, size_t threadCount = 64);
+    ~MockOmdbServer();
+
+    MockOmdbServer(const MockOmdbServer &) = delete;
+    MockOmdbServer &operator=(const MockOmdbServer &) = delete;
+
+    bool start(const std::string &host = "127.0.0.1");
+    void stop();
+
+    OMDbHosts hosts() const;
+    uint64_t requests() const { return requestCount.load(); }
+
+private:
+    static constexpr int kPageSize = 10;
+
+    void handleApi(const httplib::Request &request, httplib::Response &response);
+    void handlePoster(const httplib::Request &request, httplib::Response &response);
+
+    std::chrono::milliseconds latency;
+    std::string host;
+    httplib::Server apiServer;
+    httplib::Server imageServer;
+    int apiPort = 0;
+    int imagePort = 0;
+    std::thread apiThread;
+    std::thread imageThread;
+    std::atomic<uint64_t> requestCount{0};
+};
+
+#endif // MOCK_OMDB_SERVER_H
@@ -2,7 +2,6 @@
 #define MOVIE_H
 
 #include <string>
-#include <GL/gl.h>
 
 
 struct Movie {
@@ -11,7 +10,10 @@ struct Movie {
     std::string genre;
     std::string imdbRating;
     std::string posterUrl;  // Store poster URL
-    GLuint texture=-1;
+    std::string imdbID;     // IMDb ID, unique key of the movie
+    std::string posterPath; // Local poster file, empty until downloaded
+    int releaseYear = 0;    // First year of release, 0 if unknown
+    float rating = -1.0f;   // Numeric IMDb rating, -1 if unknown ("N/A")
 };
 
 #endif // MOVIE_H
@@ -0,0 +1,230 @@
+#include "MovieJson.h"
+#include <cctype>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+// SAX handler keeping only the OMDb fields the app uses. Keys are compared in
+// place and values nobody asked for are skipped, so the only allocations are
+// the strings copied into the result.
+class OMDbResponseHandler {
+public:
+    using json = nlohmann::json;
+
+    explicit OMDbResponseHandler(OMDbResponse &result) : result(result) {}
+
+    bool null() { return skip(); }
+    bool boolean(bool) { return skip(); }
+    bool number_integer(json::number_integer_t) { return skip(); }
+    bool number_unsigned(json::number_unsigned_t) { return skip(); }
+    bool number_float(json::number_float_t, const json::string_t &) { return skip(); }
+    bool binary(json::binary_t &) { return skip(); }
+
+    bool string(json::string_t &value) {
+        if (field) {
+            field->assign(value);
+        }
+        return skip();
+    }
+
+    bool key(json::string_t &name) {
+        field = nullptr;
+        searchNext = false;
+        if (depth == 1) {
+            // Top level: the response status, the search fields, or the movie of a details response
+            if (name == "Search") {
+                searchNext = true;
+            } else if (name == "totalResults") {
+                field = &totalResults;
+            } else if (name == "Response") {
+                field = &response;
+            } else if (name == "Error") {
+                field = &result.error;
+            } else {
+                field = movieField(result.movie, name);
+            }
+        } else if (depth == 3 && inSearch) {
+            field = movieField(result.movies.back(), name);
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        depth++;
+        if (depth == 3 && inSearch) {
+            Movie &movie = result.movies.emplace_back();
+            movie.title = "Unknown";
+            movie.year = "Unknown";
+        }
+        return skip();
+    }
+
+    bool end_object() {
+        depth--;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        depth++;
+        if (depth == 2 && searchNext) {
+            inSearch = true;
+            result.hasSearch = true;
+            result.movies.reserve(10);// A full OMDb page
+        }
+        return skip();
+    }
+
+    bool end_array() {
+        if (depth == 2) {
+            inSearch = false;
+        }
+        depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &error) {
+        result.error = error.what();
+        return false;
+    }
+
+    std::string totalResults;// Sent as a string, e.g. "1234"
+    std::string response;    // "True" or "False"
+
+private:
+    // The Movie member an OMDb field goes into, or nullptr for fields the app does not use
+    static std::string *movieField(Movie &movie, const json::string_t &name) {
+        if (name == "Title") return &movie.title;
+        if (name == "Year") return &movie.year;
+        if (name == "imdbID") return &movie.imdbID;
+        if (name == "Poster") return &movie.posterUrl;
+        if (name == "Genre") return &movie.genre;
+        if (name == "imdbRating") return &movie.imdbRating;
+        return nullptr;
+    }
+
+    // A value has been consumed: the next one needs a key of its own
+    bool skip() {
+        field = nullptr;
+        searchNext = false;
+        return true;
+    }
+
+    OMDbResponse &result;
+    std::string *field = nullptr;// Where the next string value goes
+    int depth = 0;               // Objects and arrays open around the current value
+    bool searchNext = false;     // The next value is the top-level "Search" field
+    bool inSearch = false;       // Inside the "Search" array
+};
+
+}// namespace
+
+
+/**
+ * @brief Extracts the fields the app uses from an OMDb search or details response.
+ *
+ * The body is parsed with nlohmann's SAX interface straight into Movie
+ * records: no JSON tree is built, and fields such as "Plot" or "Ratings" are
+ * skipped without being copied. Missing titles, years, genres and ratings
+ * read "Unknown", as they did when fields were copied out of a JSON tree;
+ * the movies of a search response keep an empty genre, so their details are
+ * still fetched.
+ *
+ * @param body The response body.
+ * @return The extracted fields; valid is false if the body is not well-formed JSON.
+ */
+OMDbResponse ParseOMDbResponse(std::string_view body) {
+    OMDbResponse result;
+    result.movie.title = "Unknown";
+    result.movie.year = "Unknown";
+    result.movie.genre = "Unknown";
+    result.movie.imdbRating = "Unknown";
+    OMDbResponseHandler handler(result);
+    result.valid = nlohmann::json::sax_parse(body.data(), body.data() + body.size(), &handler);
+    if (!result.valid) {
+        return result;
+    }
+    result.found = handler.response == "True";
+    std::from_chars(handler.totalResults.data(), handler.totalResults.data() + handler.totalResults.size(), result.totalResults);
+    result.movie.releaseYear = ParseReleaseYear(result.movie.year);
+    result.movie.rating = ParseImdbRating(result.movie.imdbRating);
+    for (Movie &movie: result.movies) {
+        movie.releaseYear = ParseReleaseYear(movie.year);
+    }
+    return result;
+}
+
+/**
+ * @brief Serializes a movie for clients of the lookup service.
+ *
+ * The OMDb fields keep their OMDb names, so a client can parse search results
+ * and lookups with the same code it uses for OMDb itself. The local poster
+ * path is left out; posters are served by IMDb ID.
+ *
+ * @param movie The movie.
+ * @return A JSON object.
+ */
+nlohmann::json MovieToJson(const Movie &movie) {
+    return {
+            {"Title", movie.title},
+            {"Year", movie.year},
+            {"Genre", movie.genre},
+            {"imdbRating", movie.imdbRating},
+            {"imdbID", movie.imdbID},
+            {"Poster", movie.posterUrl},
+            {"releaseYear", movie.releaseYear},
+            {"rating", movie.rating < 0.0f ? -1.0 : std::round(movie.rating * 10.0) / 10.0},// 9.2, not 9.19999980926
+    };
+}
+
+/**
+ * @brief Parses the first year of an OMDb year string.
+ *
+ * OMDb reports series as ranges such as "2008–2013" or "2019–".
+ *
+ * @param year The year string.
+ * @return The first four-digit year, or 0 if there is none.
+ */
+int ParseReleaseYear(const std::string &year) {
+    if (year.size() < 4 || !std::isdigit((unsigned char) year[0])) return 0;
+    int value = 0;
+    auto [end, ec] = std::from_chars(year.data(), year.data() + 4, value);
+    return (ec == std::errc() && end == year.data() + 4) ? value : 0;
+}
+
+/**
+ * @brief Parses the number of an IMDb ID such as "tt0076759".
+ *
+ * The number is unique per title, so it makes a stable integer ID for GUI
+ * widgets that survives sorting.
+ *
+ * @param imdbID The IMDb ID.
+ * @return The number after the "tt" prefix, or -1 if there is none.
+ */
+int ParseImdbNumber(const std::string &imdbID) {
+    if (imdbID.size() < 3 || imdbID.compare(0, 2, "tt") != 0) return -1;
+    int value = 0;
+    auto [end, ec] = std::from_chars(imdbID.data() + 2, imdbID.data() + imdbID.size(), value);
+    return (ec == std::errc() && end == imdbID.data() + imdbID.size()) ? value : -1;
+}
+
+/**
+ * @brief Parses an IMDb rating such as "7.8".
+ *
+ * @param imdbRating The rating string.
+ * @return The rating, or -1 if it is "N/A" or malformed.
+ */
+float ParseImdbRating(const std::string &imdbRating) {
+    // Ratings are always one digit or "10", a dot and one decimal
+    int whole = 0;
+    int tenths = 0;
+    const char *p = imdbRating.data();
+    const char *end = p + imdbRating.size();
+    auto [dot, ec] = std::from_chars(p, end, whole);
+    if (ec != std::errc() || whole < 0 || whole > 10) return -1.0f;
+    if (dot != end) {
+        if (*dot != '.' || dot + 2 != end || !std::isdigit((unsigned char) dot[1])) return -1.0f;
+        tenths = dot[1] - '0';
+    }
+    return whole + tenths / 10.0f;
+}
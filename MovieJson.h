@@ -0,0 +1,30 @@
+#ifndef MOVIE_JSON_H
+#define MOVIE_JSON_H
+
+#include "Movie.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The fields of an OMDb search or details response that the app uses
+struct OMDbResponse {
+    bool valid = false;       // The body is well-formed JSON
+    bool found = false;       // "Response" is "True"
+    std::string error;        // OMDb's "Error" message, or why the body is not valid JSON
+    bool hasSearch = false;   // The body has a "Search" array
+    std::vector<Movie> movies;// The "Search" array of a search response, without genres
+    int totalResults = 0;     // Matches over all pages of a search
+    Movie movie;              // The top-level fields of a details response
+};
+
+// Extracts the fields the app uses from an OMDb response with a SAX parser, without building a JSON tree
+OMDbResponse ParseOMDbResponse(std::string_view body);
+// Serializes a movie with OMDb's field names, plus the parsed year and rating
+nlohmann::json MovieToJson(const Movie& movie);
+
+int ParseReleaseYear(const std::string& year);
+int ParseImdbNumber(const std::string& imdbID);
+float ParseImdbRating(const std::string& imdbRating);
+
+#endif // MOVIE_JSON_H
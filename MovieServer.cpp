@@ -0,0 +1,172 @@
+#include "MovieServer.h"
+#include "MovieJson.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <vector>
+// JSON alias
+using json = nlohmann::json;
+
+
+/**
+ * @brief Sets up the routes; nothing is served until listen().
+ *
+ * @param api Answers the lookups; shared by all clients, together with its caches.
+ * @param catalog Local catalog searched before OMDb, or nullptr to always ask OMDb.
+ * @param threadCount Number of requests handled at the same time.
+ */
+MovieServer::MovieServer(OMDbApi &api, const LocalCatalog *catalog, size_t threadCount)
+    : api(api), catalog(catalog) {
+    server.new_task_queue = [threadCount]() { return new httplib::ThreadPool(threadCount); };
+    server.Get("/search", [this](const httplib::Request &request, httplib::Response &response) {
+        handleSearch(request, response);
+    });
+    server.Get(R"(/movie/(tt\d+))", [this](const httplib::Request &request, httplib::Response &response) {
+        handleMovie(request, response);
+    });
+    server.Get(R"(/poster/(tt\d+))", [this](const httplib::Request &request, httplib::Response &response) {
+        handlePoster(request, response);
+    });
+    server.Get("/stats", [this](const httplib::Request &request, httplib::Response &response) {
+        handleStats(request, response);
+    });
+}
+
+/**
+ * @brief Serves requests until stop() is called.
+ *
+ * @param host Address to listen on, e.g. "127.0.0.1" for local clients only.
+ * @param port TCP port.
+ * @return false if the port could not be bound.
+ */
+bool MovieServer::listen(const std::string &host, int port) {
+    std::cout << "Serving movie lookups on http://" << host << ":" << port << std::endl;
+    if (!server.listen(host, port)) {
+        std::cerr << "ERROR: Failed to listen on " << host << ":" << port << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops accepting requests and aborts the OMDb requests of the ones in flight.
+ *
+ * May be called from any thread; listen() returns once the running handlers finish.
+ */
+void MovieServer::stop() {
+    shutdownToken.cancel();
+    server.stop();
+}
+
+// GET /search?q=<query>[&page=<n>]
+void MovieServer::handleSearch(const httplib::Request &request, httplib::Response &response) {
+    std::string query = request.get_param_value("q");
+    if (query.empty()) {
+        sendError(response, 400, "Missing query parameter 'q'.");
+        return;
+    }
+    int page = request.has_param("page") ? std::atoi(request.get_param_value("page").c_str()) : 1;
+    if (page < 1 || page > kMaxPages) {
+        sendError(response, 400, "Page must be between 1 and " + std::to_string(kMaxPages) + ".");
+        return;
+    }
+    searches++;
+
+    // The catalog answers every page of a query from one lookup, like PagedSearch does
+    std::vector<Movie> local;
+    if (catalog) {
+        local = catalog->search(query, kPageSize * kMaxPages);
+        if (local.empty()) {
+            local = catalog->searchFuzzy(query, kPageSize * kMaxPages);
+        }
+    }
+    OMDbApi::SearchPage result;
+    if (!local.empty()) {
+        catalogSearches++;
+        size_t begin = std::min(local.size(), static_cast<size_t>(page - 1) * kPageSize);
+        size_t end = std::min(local.size(), begin + kPageSize);
+        result.movies.assign(local.begin() + begin, local.begin() + end);
+        result.totalResults = static_cast<int>(local.size());
+    } else if (std::optional<OMDbApi::SearchPage> fetched = api.fetchSearchPage(query, page, shutdownToken)) {
+        result = std::move(*fetched);
+    } else {
+        sendError(response, 502, "OMDb did not answer.");
+        return;
+    }
+
+    json movies = json::array();
+    for (const Movie &movie: result.movies) {
+        movies.push_back(MovieToJson(movie));
+    }
+    sendJson(response, {{"Response", "True"},
+                        {"Search", std::move(movies)},
+                        {"totalResults", std::to_string(result.totalResults)},
+                        {"source", local.empty() ? "omdb" : "catalog"}});
+}
+
+// GET /movie/<imdbID>
+void MovieServer::handleMovie(const httplib::Request &request, httplib::Response &response) {
+    lookups++;
+    if (std::optional<Movie> movie = api.lookupMovie(request.matches[1].str(), shutdownToken)) {
+        sendJson(response, MovieToJson(*movie));
+    } else {
+        sendError(response, 404, "Movie not found.");
+    }
+}
+
+// GET /poster/<imdbID>
+void MovieServer::handlePoster(const httplib::Request &request, httplib::Response &response) {
+    posters++;
+    std::string posterPath = api.fetchPoster(request.matches[1].str(), shutdownToken);
+    std::ifstream file(posterPath, std::ios::binary);
+    if (posterPath.empty() || !file) {
+        sendError(response, 404, "Poster not found.");
+        return;
+    }
+    std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    response.set_header("Cache-Control", "max-age=604800");// Posters are revalidated weekly by the poster cache
+    response.set_content(image, "image/jpeg");
+}
+
+// GET /stats
+void MovieServer::handleStats(const httplib::Request &, httplib::Response &response) {
+    ResponseCache::Stats cache = api.responseCacheStats();
+    auto requests = api.requestStats();
+    auto posterFetches = api.posterStats();
+    RequestLimiter::State limiter = api.limiterState();
+    sendJson(response, {{"searches", searches.load()},
+                        {"catalogSearches", catalogSearches.load()},
+                        {"lookups", lookups.load()},
+                        {"posters", posters.load()},
+                        {"responseCache", {{"hits", cache.hits},
+                                           {"misses", cache.misses},
+                                           {"entries", cache.entries},
+                                           {"liveBytes", cache.liveBytes}}},
+                        {"omdbRequests", {{"issued", requests.issued}, {"coalesced", requests.coalesced}}},
+                        {"posterFetches", {{"issued", posterFetches.issued}, {"coalesced", posterFetches.coalesced}}},
+                        {"limiter", {{"throttled", limiter.waiting > 0 || limiter.quotaExhausted},
+                                     {"concurrencyLimit", limiter.concurrencyLimit},
+                                     {"inFlight", limiter.inFlight},
+                                     {"waiting", limiter.waiting},
+                                     {"tokens", limiter.tokens},
+                                     {"usedToday", limiter.usedToday},
+                                     {"dailyBudget", limiter.dailyBudget},
+                                     {"quotaExhausted", limiter.quotaExhausted},
+                                     {"throttledRequests", limiter.throttled},
+                                     {"refusedRequests", limiter.refused},
+                                     {"retries", limiter.retries},
+                                     {"transientErrors", limiter.transientErrors}}}});
+}
+
+void MovieServer::sendJson(httplib::Response &response, const json &body, int status) {
+    response.status = status;
+    response.set_content(body.dump(), "application/json");
+}
+
+// Errors are shaped like OMDb's, e.g. {"Response":"False","Error":"Movie not found!"}
+void MovieServer::sendError(httplib::Response &response, int status, const std::string &message) {
+    sendJson(response, {{"Response", "False"}, {"Error", message}}, status);
+}
@@ -0,0 +1,68 @@
+#ifndef MOVIE_SERVER_H
+#define MOVIE_SERVER_H
+
+#include "CancellationToken.h"
+#include "LocalCatalog.h"
+#include "OMDbApi.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <string>
+
+
+/**
+ * @class MovieServer
+ * @brief A headless HTTP service answering search, details and poster lookups.
+ *
+ * All clients share one OMDbApi, so they share its response cache, poster
+ * cache and keep-alive connections to OMDb. A movie looked up by one user is
+ * served from the warm cache to every other user of the host. Searches are
+ * answered from the local catalog when it has a match.
+ *
+ * Endpoints (all GET):
+ * - /search?q=<query>[&page=<n>]: one page of up to 10 movies, shaped like an
+ *   OMDb search response ("Search", "totalResults");
+ * - /movie/<imdbID>: one movie with genre and rating;
+ * - /poster/<imdbID>: the poster image (JPEG);
+ * - /stats: request, cache and coalescing counters, and the state of the
+ *   OMDb request limiter ("throttled" while requests wait or the quota is used up).
+ *
+ * Requests are handled concurrently by a pool of threadCount threads. The
+ * outgoing requests are bounded by the OMDbApi's connection pools, so a burst
+ * of clients queues there instead of opening unbounded connections to OMDb.
+ */
+class MovieServer {
+public:
+    MovieServer(OMDbApi &api, const LocalCatalog *catalog, size_t threadCount = 32);
+
+    MovieServer(const MovieServer &) = delete;
+    MovieServer &operator=(const MovieServer &) = delete;
+
+    bool listen(const std::string &host, int port);
+    void stop();
+
+private:
+    static constexpr int kPageSize = 10; // Movies per search page, as on OMDb
+    static constexpr int kMaxPages = 100;// Pages served per query, as on OMDb
+
+    void handleSearch(const httplib::Request &request, httplib::Response &response);
+    void handleMovie(const httplib::Request &request, httplib::Response &response);
+    void handlePoster(const httplib::Request &request, httplib::Response &response);
+    void handleStats(const httplib::Request &request, httplib::Response &response);
+    static void sendJson(httplib::Response &response, const nlohmann::json &body, int status = 200);
+    static void sendError(httplib::Response &response, int status, const std::string &message);
+
+    OMDbApi &api;
+    const LocalCatalog *catalog;// Searched before OMDb, nullptr if not built
+    httplib::Server server;
+    CancellationToken shutdownToken;// Aborts the outgoing requests of handlers still running at stop()
+
+    std::atomic<uint64_t> searches{0};
+    std::atomic<uint64_t> catalogSearches{0};// Searches answered by the local catalog
+    std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> posters{0};
+};
+
+#endif // MOVIE_SERVER_H
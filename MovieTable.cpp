@@ -0,0 +1,384 @@
+#include "MovieTable.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <numeric>
+
+
+/**
+ * @brief Creates an empty table.
+ *
+ * @param scheduler Runs sorts of large tables, or nullptr to sort on the calling thread.
+ * @param asyncSortRows Row count from which sorts run on the scheduler.
+ */
+MovieTable::MovieTable(TaskScheduler *scheduler, size_t asyncSortRows)
+    : scheduler(scheduler), asyncSortRows(asyncSortRows) {}
+
+/**
+ * @brief Drops every row and the title dictionary.
+ *
+ * The genre dictionary, the sort keys and the filter are kept, so they still
+ * apply to the next search's results. A pending background sort is abandoned.
+ */
+void MovieTable::clear() {
+    titleIds.clear();
+    years.clear();
+    ratings.clear();
+    genreBits.clear();
+    foldedTitles = std::make_shared<TitleList>();// A running sort keeps the old titles alive
+    titleIndex.clear();
+    sorted.clear();
+    order.clear();
+    pendingSort = {};
+    sortedRows = 0;
+    sortValid = true;
+    passes.clear();
+    std::fill(genreCounts.begin(), genreCounts.end(), 0);
+    earliestYear = 0;
+    latestYear = 0;
+}
+
+/**
+ * @brief Brings the table up to date with the movie list.
+ *
+ * Movies are only ever appended to the list between resets, so only the new
+ * tail is read and merged into the current order. Also picks up the result
+ * of a background sort once it is done.
+ *
+ * @param movies The movie list rendered by the GUI.
+ * @param reset The list was cleared since the last call.
+ * @return true if the displayed rows or their order changed.
+ */
+bool MovieTable::sync(const std::vector<Movie> &movies, bool reset) {
+    bool changed = false;
+    if (reset || movies.size() < titleIds.size()) {
+        changed = !titleIds.empty();
+        clear();
+    }
+    size_t firstRow = titleIds.size();
+    for (size_t row = firstRow; row < movies.size(); row++) {
+        append(movies[row]);
+    }
+    if (titleIds.size() > firstRow) {
+        if (sortValid) {
+            mergeRows(firstRow);
+        } else {
+            // A background sort is pending; its result is merged with these rows when it arrives
+            for (size_t row = firstRow; row < titleIds.size(); row++) {
+                sorted.push_back(static_cast<uint32_t>(row));
+            }
+        }
+        changed = true;
+    }
+    if (finishSort()) {
+        changed = true;
+    } else if (changed) {
+        applyFilter();
+    }
+    return changed;
+}
+
+/**
+ * @brief Orders the rows by a list of columns; an empty list restores arrival order.
+ *
+ * The first key decides, later keys break its ties, and rows that tie on
+ * every key keep their arrival order. A large table is sorted in the
+ * background and keeps its previous order until sync() picks up the result.
+ *
+ * @param keys Sort keys, most significant first.
+ */
+void MovieTable::sortBy(const std::vector<SortKey> &keys) {
+    this->keys.clear();
+    for (const SortKey &key: keys) {
+        if (key.column != None) {
+            this->keys.push_back(key);
+        }
+    }
+    startSort();
+}
+
+/**
+ * @brief Hides the rows that do not match the filter and recounts the genre facets.
+ *
+ * @param filter The new filter.
+ */
+void MovieTable::setFilter(const Filter &filter) {
+    if (filter == activeFilter) {
+        return;
+    }
+    activeFilter = filter;
+    applyFilter();
+}
+
+void MovieTable::append(const Movie &movie) {
+    auto [title, added] = titleIndex.try_emplace(movie.title, static_cast<uint32_t>(foldedTitles->size()));
+    if (added) {
+        std::string folded = movie.title;
+        for (char &c: folded) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        foldedTitles->push_back(std::move(folded));
+    }
+    titleIds.push_back(title->second);
+    uint16_t year = static_cast<uint16_t>(std::clamp(movie.releaseYear, 0, 65535));
+    years.push_back(year);
+    if (year != 0) {
+        earliestYear = earliestYear == 0 ? year : std::min(earliestYear, year);
+        latestYear = std::max(latestYear, year);
+    }
+    ratings.push_back(movie.rating < 0.0f ? int16_t(-1) : static_cast<int16_t>(movie.rating * 10.0f + 0.5f));
+    genreBits.push_back(genreMask(movie.genre));
+}
+
+// Rebuild the whole order from the sort keys, in the background if the table is large
+void MovieTable::startSort() {
+    size_t rows = titleIds.size();
+    pendingSort = {};// A superseded background sort finishes unobserved
+    if (keys.empty() || rows < 2) {
+        sorted.resize(rows);
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        sortValid = true;
+        applyFilter();
+        return;
+    }
+    if (scheduler == nullptr || rows < asyncSortRows) {
+        sorted = runSort(sortInput());
+        sortValid = true;
+        applyFilter();
+        return;
+    }
+
+    // The job sorts copies of the columns, so rows can keep streaming in meanwhile
+    struct Snapshot {
+        std::vector<uint32_t> titleIds;
+        std::vector<uint16_t> years;
+        std::vector<int16_t> ratings;
+        std::shared_ptr<const TitleList> titles;
+        SortInput input;
+    };
+    auto snapshot = std::make_shared<Snapshot>(Snapshot{titleIds, years, ratings, foldedTitles, sortInput()});
+    snapshot->input.titleIds = snapshot->titleIds;
+    snapshot->input.years = snapshot->years;
+    snapshot->input.ratings = snapshot->ratings;
+    auto promise = std::make_shared<std::promise<std::vector<uint32_t>>>();
+    pendingSort = promise->get_future();
+    sortedRows = rows;
+    sortValid = false;
+    scheduler->submit(TaskPriority::Visible, [snapshot, promise, wake = wake]() {
+        try {
+            promise->set_value(runSort(snapshot->input));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+        if (wake) {
+            wake();
+        }
+    });
+}
+
+// Adopt a finished background sort and merge in the rows that arrived while it ran
+bool MovieTable::finishSort() {
+    if (!pendingSort.valid() || pendingSort.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+    try {
+        sorted = pendingSort.get();
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: Background sort failed: " << e.what() << std::endl;
+        sorted = runSort(sortInput());
+        sortValid = true;
+        applyFilter();
+        return true;
+    }
+    sorted.resize(sortedRows);
+    sortValid = true;
+    mergeRows(sortedRows);
+    applyFilter();
+    return true;
+}
+
+// Sort the rows from firstRow on by themselves and merge them into the sorted rows before them
+void MovieTable::mergeRows(size_t firstRow) {
+    sorted.resize(firstRow);
+    for (size_t row = firstRow; row < titleIds.size(); row++) {
+        sorted.push_back(static_cast<uint32_t>(row));
+    }
+    if (keys.empty()) {
+        return;// Arrival order, the new rows already belong at the end
+    }
+    auto compare = [this](uint32_t a, uint32_t b) { return rowLess(a, b); };
+    auto middle = sorted.begin() + static_cast<std::ptrdiff_t>(firstRow);
+    std::sort(middle, sorted.end(), compare);
+    std::inplace_merge(sorted.begin(), middle, sorted.end(), compare);
+}
+
+// The order runSort() produces, for two rows: key by key, then by row number
+bool MovieTable::rowLess(uint32_t a, uint32_t b) const {
+    for (const SortKey &key: keys) {
+        int compare = 0;
+        switch (key.column) {
+            case Title: {
+                uint32_t titleA = titleIds[a];
+                uint32_t titleB = titleIds[b];
+                if (titleA != titleB) {
+                    compare = (*foldedTitles)[titleA].compare((*foldedTitles)[titleB]);
+                    if (compare == 0) {
+                        compare = titleA < titleB ? -1 : 1;
+                    }
+                }
+                break;
+            }
+            case Year: compare = int(years[a]) - int(years[b]); break;
+            case Rating: compare = int(ratings[a]) - int(ratings[b]); break;
+            case None: break;
+        }
+        if (compare != 0) {
+            return key.ascending ? compare < 0 : compare > 0;
+        }
+    }
+    return a < b;
+}
+
+// The sort keys and views of the columns, for a sort on this thread
+MovieTable::SortInput MovieTable::sortInput() const {
+    SortInput input{keys, titleIds, years, ratings, {}};
+    bool byTitle = std::any_of(keys.begin(), keys.end(), [](const SortKey &key) { return key.column == Title; });
+    if (byTitle) {
+        input.titles.assign(foldedTitles->begin(), foldedTitles->end());
+    }
+    return input;
+}
+
+// Stable LSD radix sort of the row numbers, one key at a time from the least significant
+std::vector<uint32_t> MovieTable::runSort(const SortInput &input) {
+    size_t rows = input.titleIds.size();
+    std::vector<uint32_t> sorted(rows);
+    std::iota(sorted.begin(), sorted.end(), 0u);
+    if (rows == 0) {
+        return sorted;
+    }
+
+    // Each distinct title gets its position in case-insensitive order; equal spellings in different case by ID
+    std::vector<uint32_t> titleRanks;
+    if (!input.titles.empty()) {
+        std::vector<uint32_t> byTitle(input.titles.size());
+        std::iota(byTitle.begin(), byTitle.end(), 0u);
+        std::sort(byTitle.begin(), byTitle.end(), [&](uint32_t a, uint32_t b) {
+            int compare = input.titles[a].compare(input.titles[b]);
+            return compare != 0 ? compare < 0 : a < b;
+        });
+        titleRanks.resize(byTitle.size());
+        for (uint32_t rank = 0; rank < byTitle.size(); rank++) {
+            titleRanks[byTitle[rank]] = rank;
+        }
+    }
+
+    std::vector<uint32_t> keys(rows);
+    std::vector<uint32_t> scratch(rows);
+    std::vector<uint32_t> offsets(65537);
+    for (auto key = input.keys.rbegin(); key != input.keys.rend(); ++key) {
+        for (uint32_t row = 0; row < rows; row++) {
+            uint32_t value = 0;
+            switch (key->column) {
+                case Title: value = titleRanks[input.titleIds[row]]; break;
+                case Year: value = input.years[row]; break;
+                case Rating: value = static_cast<uint32_t>(input.ratings[row] + 1); break;
+                case None: break;
+            }
+            keys[row] = key->ascending ? value : ~value;
+        }
+        // 16 bits per pass; each pass is stable, so ties keep the order of the less significant keys
+        for (int shift = 0; shift < 32; shift += 16) {
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (uint32_t row: sorted) {
+                offsets[((keys[row] >> shift) & 0xFFFF) + 1]++;
+            }
+            if (offsets[((keys[sorted[0]] >> shift) & 0xFFFF) + 1] == rows) {
+                continue;// Every key has the same digit, the pass would not move anything
+            }
+            for (size_t digit = 1; digit < offsets.size(); digit++) {
+                offsets[digit] += offsets[digit - 1];
+            }
+            for (uint32_t row: sorted) {
+                scratch[offsets[(keys[row] >> shift) & 0xFFFF]++] = row;
+            }
+            sorted.swap(scratch);
+        }
+    }
+    return sorted;
+}
+
+// Evaluate the filter over the key arrays, count the genre facets and keep the passing rows in sort order
+void MovieTable::applyFilter() {
+    size_t rows = titleIds.size();
+    const Filter &filter = activeFilter;
+    genreCounts.assign(genreNames.size(), 0);
+    if (!filter.active()) {
+        order = sorted;
+        for (uint64_t bits: genreBits) {
+            for (; bits != 0; bits &= bits - 1) {
+                genreCounts[std::countr_zero(bits)]++;
+            }
+        }
+        return;
+    }
+
+    // Branch-free predicate per row; the loop has no early exits, so the compiler can vectorize it
+    bool openYears = filter.minYear == 0 && filter.maxYear == 65535;
+    passes.resize(rows);
+    const uint16_t *year = years.data();
+    const int16_t *rating = ratings.data();
+    const uint64_t *genre = genreBits.data();
+    uint8_t *pass = passes.data();
+    for (size_t row = 0; row < rows; row++) {
+        bool inYears = openYears | ((year[row] >= filter.minYear) & (year[row] <= filter.maxYear) & (year[row] != 0));
+        pass[row] = static_cast<uint8_t>(inYears & (rating[row] >= filter.minRating) & ((genre[row] & filter.genres) == filter.genres));
+    }
+
+    // Facets: a row counts for each genre it has, as that genre's checkbox would keep it
+    for (size_t row = 0; row < rows; row++) {
+        if (pass[row]) {
+            for (uint64_t bits = genre[row]; bits != 0; bits &= bits - 1) {
+                genreCounts[std::countr_zero(bits)]++;
+            }
+        }
+    }
+
+    order.clear();
+    for (uint32_t row: sorted) {
+        if (pass[row]) {
+            order.push_back(row);
+        }
+    }
+}
+
+// Bitset of a comma-separated genre list such as "Action, Adventure, Sci-Fi"
+uint64_t MovieTable::genreMask(const std::string &genre) {
+    uint64_t mask = 0;
+    size_t start = 0;
+    while (start < genre.size()) {
+        size_t comma = genre.find(',', start);
+        size_t end = comma == std::string::npos ? genre.size() : comma;
+        size_t first = genre.find_first_not_of(' ', start);
+        size_t last = genre.find_last_not_of(' ', end - 1);
+        if (first < end && last != std::string::npos && last >= first) {
+            std::string name = genre.substr(first, last - first + 1);
+            if (name != "N/A" && name != "Unknown") {
+                auto it = genreIndex.find(name);
+                if (it == genreIndex.end() && genreNames.size() < kMaxGenres) {
+                    it = genreIndex.emplace(name, genreNames.size()).first;
+                    genreNames.push_back(name);
+                }
+                if (it != genreIndex.end()) {
+                    mask |= uint64_t(1) << it->second;
+                }
+            }
+        }
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return mask;
+}
@@ -0,0 +1,157 @@
+#ifndef MOVIE_TABLE_H
+#define MOVIE_TABLE_H
+
+#include "Movie.h"
+#include "TaskScheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * @class MovieTable
+ * @brief Columnar sort keys and display order of the movies in the results table.
+ *
+ * The Movie structs stay where they are and are never moved. The table keeps
+ * one array per sortable column, filled in as rows are appended:
+ * - interned title IDs,
+ * - release years as uint16,
+ * - ratings in tenths (fixed point, -1 if unknown),
+ * - genre bitsets.
+ * Sorting only permutes an array of row numbers, with a radix sort on integer
+ * keys. Strings are neither compared nor copied, except once per distinct
+ * title to rank the title dictionary. The GUI draws row
+ * rowAt(i) at position i.
+ *
+ * Rows are ordered by a list of sort keys, as given by the multi-column sort
+ * specs of an ImGui table. A full sort is a stable LSD radix sort, one key at
+ * a time from the least significant. From asyncSortRows rows on it runs on
+ * the task scheduler over copies of the key columns, and the previous order
+ * stays on screen until it is done. Rows that stream in while the order is
+ * valid are sorted on their own and merged into it, so a batch of k rows
+ * costs O(k log k + n) instead of a full sort.
+ *
+ * A Filter hides rows by genre, year range and minimum rating. It is
+ * evaluated with one branch-free pass over the key arrays. A second pass
+ * counts, for every genre, how many rows would match if that genre were
+ * also required (the facet counts shown next to the genre checkboxes).
+ *
+ * Must only be used on the GUI thread.
+ */
+class MovieTable {
+public:
+    // Sortable columns, used as ImGui column user IDs
+    enum Column { None,
+                  Title,
+                  Year,
+                  Rating };
+
+    struct SortKey {
+        Column column = None;
+        bool ascending = true;
+
+        bool operator==(const SortKey &) const = default;
+    };
+
+    static constexpr size_t kMaxGenres = 64;// Genres beyond this many are not tracked in the bitsets
+
+    struct Filter {
+        uint64_t genres = 0;     // Genres a row must all have
+        uint16_t minYear = 0;    // Years outside [minYear, maxYear] are hidden; unknown years only pass an open range
+        uint16_t maxYear = 65535;
+        int16_t minRating = -1;  // Tenths of a point; -1 also shows unrated movies
+
+        bool active() const { return genres != 0 || minYear != 0 || maxYear != 65535 || minRating != -1; }
+        bool operator==(const Filter &) const = default;
+    };
+
+    explicit MovieTable(TaskScheduler *scheduler = nullptr, size_t asyncSortRows = 20000);
+
+    MovieTable(const MovieTable &) = delete;
+    MovieTable &operator=(const MovieTable &) = delete;
+
+    void setWakeCallback(std::function<void()> callback) { wake = std::move(callback); }
+
+    void clear();
+    bool sync(const std::vector<Movie> &movies, bool reset);
+    void sortBy(Column column, bool ascending) { sortBy(std::vector<SortKey>{{column, ascending}}); }
+    void sortBy(const std::vector<SortKey> &keys);
+    void setFilter(const Filter &filter);
+
+    size_t size() const { return order.size(); }
+    size_t totalRows() const { return titleIds.size(); }
+    const Filter &filter() const { return activeFilter; }
+    uint32_t genreMatches(size_t bit) const { return genreCounts[bit]; }
+    uint16_t minKnownYear() const { return earliestYear; }
+    uint16_t maxKnownYear() const { return latestYear; }
+    uint32_t rowAt(size_t position) const { return order[position]; }
+    const std::vector<SortKey> &sortKeys() const { return keys; }
+    bool sorting() const { return pendingSort.valid(); }
+
+    uint16_t year(uint32_t row) const { return years[row]; }
+    int16_t rating(uint32_t row) const { return ratings[row]; }
+    uint64_t genres(uint32_t row) const { return genreBits[row]; }
+    size_t genreCount() const { return genreNames.size(); }
+    const std::string &genreName(size_t bit) const { return genreNames[bit]; }
+
+private:
+    using TitleList = std::deque<std::string>;// Elements stay in place as titles are added
+
+    // What a full sort reads; the spans point into the table or into a snapshot of it
+    struct SortInput {
+        std::vector<SortKey> keys;
+        std::span<const uint32_t> titleIds;
+        std::span<const uint16_t> years;
+        std::span<const int16_t> ratings;
+        std::vector<std::string_view> titles;// Lower-case titles by ID, only filled when sorting by title
+    };
+
+    void append(const Movie &movie);
+    void startSort();
+    bool finishSort();
+    void mergeRows(size_t firstRow);
+    bool rowLess(uint32_t a, uint32_t b) const;
+    void applyFilter();
+    uint64_t genreMask(const std::string &genre);
+    SortInput sortInput() const;
+    static std::vector<uint32_t> runSort(const SortInput &input);
+
+    TaskScheduler *scheduler;// Runs large sorts, nullptr to always sort on the calling thread
+    size_t asyncSortRows;    // Smallest table sorted on the scheduler
+    std::function<void()> wake;// Wakes the GUI thread when a background sort is done
+
+    // Columns, indexed by row number (the movie's position in the movie list)
+    std::vector<uint32_t> titleIds;
+    std::vector<uint16_t> years;   // 0 if unknown
+    std::vector<int16_t> ratings;  // Tenths of a point, -1 if unknown
+    std::vector<uint64_t> genreBits;
+
+    std::shared_ptr<TitleList> foldedTitles = std::make_shared<TitleList>();// Lower-case titles by ID, shared with background sorts
+    std::unordered_map<std::string, uint32_t> titleIndex;                  // Title -> ID
+
+    std::vector<std::string> genreNames;                  // Interned genres by bit
+    std::unordered_map<std::string, size_t> genreIndex;   // Genre -> bit
+
+    std::vector<SortKey> keys;   // Most significant first, empty for arrival order
+    std::vector<uint32_t> sorted;// All row numbers in sort order
+    std::vector<uint32_t> order; // Row numbers passing the filter, in sort order
+    std::future<std::vector<uint32_t>> pendingSort;// Background sort of the first sortedRows rows
+    size_t sortedRows = 0;
+    bool sortValid = true;       // sorted follows keys; false while a background sort is pending
+
+    Filter activeFilter;
+    std::vector<uint8_t> passes;       // 1 if the row passes the filter, by row number
+    std::vector<uint32_t> genreCounts; // Facet count of each genre, by bit
+    uint16_t earliestYear = 0;         // Range of the known release years, 0 if none
+    uint16_t latestYear = 0;
+};
+
+#endif // MOVIE_TABLE_H
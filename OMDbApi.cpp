@@ -1,102 +1,337 @@
 #include "OMDbApi.h"
-#include "ImageLoader.h"
+#include "MovieJson.h"
 #include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
-#include <nlohmann/json.hpp>
-// JSON alias
-using json = nlohmann::json;
+#include <mutex>
+#include <thread>
 
-// Constructor: Initialize API client
-OMDbApi::OMDbApi(const std::string &apiKey)
-    : apiKey(apiKey), client("www.omdbapi.com", 80) {}
+
+// Constructor: Initialize the response cache, the request limiter and the per-host connection pools, one connection per worker.
+// The day's request count is kept in omdb_usage.txt next to the response cache, shared by every process using it.
+OMDbApi::OMDbApi(const std::string &apiKey, TaskScheduler &scheduler, const std::string &cachePath,
+                 const RequestLimiter::Config &limits, const OMDbHosts &hosts)
+    : apiKey(apiKey), responseCache(cachePath), scheduler(scheduler),
+      limiter(limits, (std::filesystem::path(cachePath).parent_path() / "omdb_usage.txt").string()),
+      apiHost(hosts.api, hosts.apiPort, limits.maxConcurrency),
+      imageHost(hosts.image, hosts.imagePort, scheduler.workerCount()), requestFlight(scheduler, &network),
+      posterFlight(scheduler), network(2 * limits.maxConcurrency) {}
 
 /**
  * @brief Searches for movies using the OMDb API based on the provided query.
  *
- * This function sends a search request to the OMDb API with the given query,
- * retrieves the search results, and then fetches additional details for each
- * movie, including genre and IMDb rating. It also attempts to download the
- * movie poster and save it to the cache directory.
+ * This function collects the results of the streaming searchMovies overload.
+ * Movies are returned in the order their details arrived.
+ *
+ * @param query The search query string.
+ * @return A vector of movies with title, year, genre, IMDb rating and IMDb ID.
+ */
+std::vector<Movie> OMDbApi::searchMovies(const std::string &query) {
+    std::vector<Movie> movies;// Vector to store the results
+    std::mutex moviesMutex;   // Results arrive on several fetch threads
+
+    searchMovies(
+            query,
+            [&](const Movie &movie) {
+                std::lock_guard<std::mutex> lock(moviesMutex);
+                movies.push_back(movie);
+            },
+            [](const std::string &, const std::string &) {});
+    return movies;
+}
+
+/**
+ * @brief Searches for movies and streams each result as soon as it is complete.
+ *
+ * This function fetches the first page of search results and completes each
+ * movie with completeMovies(). Each movie is handed to onMovie as soon as its
+ * details arrive, and onPoster reports each poster download separately, so
+ * callers can show rows before the slowest poster finishes. The function
+ * returns once every request has completed.
  *
  * @param query The search query string.
- * @return A vector of strings containing movie titles along with their year,
- *         genre, IMDb rating, and IMDb ID.
+ * @param onMovie Called once per movie, from a fetch thread.
+ * @param onPoster Called once per movie with the local poster path (empty if unavailable), from a fetch thread.
+ * @param token Abandons the remaining requests when cancelled; no callbacks run after that.
+ */
+void OMDbApi::searchMovies(const std::string &query, const MovieCallback &onMovie, const PosterCallback &onPoster,
+                           const CancellationToken &token) {
+    if (std::optional<SearchPage> page = fetchSearchPage(query, 1, token)) {
+        completeMovies(page->movies, onMovie, onPoster, token);
+    }
+}
+
+/**
+ * @brief Fetches one page of search results.
+ *
+ * OMDb returns 10 movies per page together with the total number of matches,
+ * so callers can decide whether to fetch more pages.
  *
- * The format of each string in the returned vector is:
- * "Title (Year) (Genre) (IMDb Rating) (IMDb ID)"
+ * @param query The search query string.
+ * @param page The 1-based result page.
+ * @param token Abandons the request when cancelled.
+ * @param priority Background requests wait for the more urgent ones and leave them a reserve of the daily budget.
+ * @return The page, or std::nullopt if the request failed or was cancelled.
  *
- * @note The function logs debug information and errors to the standard output
- *       and standard error streams, respectively.
- * @note The function uses the `client` object to send HTTP requests and the
- *       `json` library to parse JSON responses.
+ * @note The function logs errors to the standard error stream.
  * @note The function assumes that the `apiKey` member variable is set with a
  *       valid OMDb API key.
  */
-std::vector<std::string> OMDbApi::searchMovies(const std::string &query) {
-    std::vector<std::string> movieTitles;// Vector to store movie titles
-
+std::optional<OMDbApi::SearchPage> OMDbApi::fetchSearchPage(const std::string &query, int page, const CancellationToken &token,
+                                                            TaskPriority priority) {
     std::string formattedQuery = query;                                  // Replace spaces with '+' in query
     std::replace(formattedQuery.begin(), formattedQuery.end(), ' ', '+');// Replace spaces with '+'
     // Build the endpoint URL
-    std::string endpoint = "/?apikey=" + apiKey + "&s=" + formattedQuery;
-    // Send the search request to the OMDb API
-    auto res = client.Get(endpoint.c_str());
+    std::string endpoint = "/?apikey=" + apiKey + "&s=" + formattedQuery + "&page=" + std::to_string(page);
+    // Send the search request to the OMDb API, or reuse a cached response
+    std::optional<std::string> body = fetchBody(ResponseCache::searchKey(query, page), endpoint, token, priority);
+    if (!body) {
+        return std::nullopt;
+    }
+
+    SearchPage result;
+    // Extract the movies straight from the response, without building a JSON tree
+    OMDbResponse response = ParseOMDbResponse(*body);
+    if (!response.valid) {
+        std::cerr << "ERROR: Failed to parse JSON response: " << response.error << std::endl;
+    } else if (!response.hasSearch) {
+        std::cerr << "ERROR: No 'Search' field in response. Full response: " << *body << std::endl;
+    } else {
+        result.movies = std::move(response.movies);
+        result.totalResults = response.totalResults;
+    }
+    return result;
+}
+
+/**
+ * @brief Fetches the details and posters of movies returned by fetchSearchPage().
+ *
+ * The detail and poster requests of all movies run in parallel on the task
+ * scheduler. The function returns once every request has completed. Movies
+ * whose genre is already known skip the details request.
+ *
+ * Cancelling the token aborts the requests in flight and turns the queued
+ * ones into no-ops, so a search the user has moved on from stops using the
+ * network almost immediately.
+ *
+ * @param movies The movies to complete.
+ * @param onMovie Called once per movie, from a fetch thread.
+ * @param onPoster Called once per movie with the local poster path (empty if unavailable), from a fetch thread.
+ * @param token Abandons the remaining requests when cancelled; no callbacks run after that.
+ * @param priority Scheduling class of the detail and poster requests.
+ */
+void OMDbApi::completeMovies(const std::vector<Movie> &movies, const MovieCallback &onMovie, const PosterCallback &onPoster,
+                             const CancellationToken &token, TaskPriority priority) {
+    std::vector<std::future<void>> pending;// Detail and poster requests in flight
+    // Fan out the detail and poster requests for every movie
+    for (const Movie &movie: movies) {
+        // Fetch additional details for the movie and publish it
+        pending.push_back(scheduler.submit(priority, [this, movie, token, priority, &onMovie]() {
+            if (token.cancelled()) {
+                return;// Superseded while queued
+            }
+            // Movies from the local catalog already have their details
+            Movie detailed = movie.genre.empty() ? fetchMovieDetails(movie, token, priority) : movie;
+            if (!token.cancelled()) {
+                onMovie(detailed);
+            }
+        }));
+
+        // Serve the movie poster from the poster cache, downloading it if needed
+        pending.push_back(scheduler.submit(priority, [this, movie, token, &onPoster]() {
+            if (token.cancelled()) {
+                return;// Superseded while queued
+            }
+            std::string posterPath = fetchPoster(movie.imdbID, token);
+            if (token.cancelled()) {
+                return;
+            }
+            if (posterPath.empty()) {
+                std::cerr << "ERROR: Failed to download poster for " << movie.title << std::endl;
+            }
+            onPoster(movie.imdbID, posterPath);
+        }));
+    }
+
+    // Wait for every request, the callbacks reference this stack frame
+    for (auto &request: pending) {
+        scheduler.wait(request);// Runs queued requests meanwhile if called on a worker
+    }
+}
+
+/**
+ * @brief Fetches the genre and IMDb rating of a movie.
+ *
+ * @param movie The movie as returned by the search request.
+ * @param token Abandons the request when cancelled.
+ * @param priority Scheduling class of the request, see fetchSearchPage().
+ * @return The movie with genre and IMDb rating filled in, or "Unknown" on failure.
+ */
+Movie OMDbApi::fetchMovieDetails(Movie movie, const CancellationToken &token, TaskPriority priority) {
+    movie.genre = "Unknown";     // Initialize genres
+    movie.imdbRating = "Unknown";// Initialize IMDb rating
+    if (movie.imdbID.empty()) {
+        return movie;
+    }
+
+    std::string detailsEndpoint = "/?apikey=" + apiKey + "&i=" + movie.imdbID;// Build the details endpoint URL
+    // Send the request to fetch movie details, or reuse a cached response
+    std::optional<std::string> detailsBody = fetchBody(ResponseCache::detailsKey(movie.imdbID), detailsEndpoint, token, priority);
     // Check if the request was successful
-    if (!res) {
-        std::cerr << "ERROR: Failed to connect to OMDb API." << std::endl;
-        return movieTitles;
+    if (detailsBody) {
+        OMDbResponse details = ParseOMDbResponse(*detailsBody);
+        if (details.valid) {
+            movie.genre = std::move(details.movie.genre);          // Get movie genre
+            movie.imdbRating = std::move(details.movie.imdbRating);// Get IMDb rating
+            movie.rating = details.movie.rating;
+        } else {
+            std::cerr << "ERROR: Failed to parse details for IMDb ID: " << movie.imdbID << ": " << details.error << std::endl;
+        }
+    } else if (!token.cancelled()) {
+        std::cerr << "ERROR: Failed to fetch details for IMDb ID: " << movie.imdbID << std::endl;
+    }
+    return movie;
+}
+
+/**
+ * @brief Fetches one movie with its details by IMDb ID.
+ *
+ * The details response carries the same title, year and poster fields as a
+ * search result, so a single (usually cached) request fills in the whole movie.
+ *
+ * @param imdbID The IMDb ID, e.g. "tt0076759".
+ * @param token Abandons the request when cancelled.
+ * @param priority Scheduling class of the request, see fetchSearchPage().
+ * @return The movie, or std::nullopt if OMDb does not know it or the request failed.
+ */
+std::optional<Movie> OMDbApi::lookupMovie(const std::string &imdbID, const CancellationToken &token, TaskPriority priority) {
+    std::string detailsEndpoint = "/?apikey=" + apiKey + "&i=" + imdbID;
+    std::optional<std::string> detailsBody = fetchBody(ResponseCache::detailsKey(imdbID), detailsEndpoint, token, priority);
+    if (!detailsBody) {
+        return std::nullopt;
+    }
+    OMDbResponse details = ParseOMDbResponse(*detailsBody);
+    if (!details.valid) {
+        std::cerr << "ERROR: Failed to parse details for IMDb ID: " << imdbID << ": " << details.error << std::endl;
+        return std::nullopt;
     }
+    if (!details.found) {
+        return std::nullopt;// E.g. "Incorrect IMDb ID."
+    }
+    return std::move(details.movie);
+}
+
+/**
+ * @brief Returns the local path of a movie's poster, downloading it into the poster cache if needed.
+ *
+ * Concurrent calls for the same movie, e.g. from two searches sharing a
+ * result, wait for one download instead of each fetching the poster.
+ *
+ * @param imdbID The IMDb ID of the movie.
+ * @param token Abandons the download when cancelled.
+ * @return The poster file, or an empty string if the movie has no poster or the download failed.
+ */
+std::string OMDbApi::fetchPoster(const std::string &imdbID, const CancellationToken &token) {
+    return posterFlight.run(imdbID, token, [&]() { return posterCache.fetch(imageHost, imdbID, apiKey, token); });
+}
+
+/**
+ * @brief Returns the response cache counters, e.g. to see how many requests were saved.
+ */
+ResponseCache::Stats OMDbApi::responseCacheStats() const {
+    return responseCache.stats();
+}
 
-    // Check if the API returned an error
-    if (res->status != 200) {
-        std::cerr << "ERROR: OMDb API returned HTTP " << res->status << std::endl;
-        return movieTitles;
+/**
+ * @brief Returns the body of an OMDb API request, served from the response cache when possible.
+ *
+ * Successful responses ("Response":"True") are stored in the cache; errors
+ * such as "Movie not found!" or "Request limit reached!" are not. A request
+ * that is already in flight for another caller, e.g. the details of a movie
+ * found by two searches typed in quick succession, is shared, not repeated.
+ *
+ * Requests that go to the network run on the API's own network pool, where
+ * they wait for a permit from the request limiter. Connection failures,
+ * timeouts, HTTP 429 and 5xx responses are retried there after a jittered
+ * backoff; "Request limit reached!" stops all requests until the quota
+ * resets. The caller waits with TaskScheduler::wait(), so a throttled or
+ * backing-off request never parks one of the shared workers that decode
+ * visible posters and sort the table.
+ *
+ * @param cacheKey The cache key of the request.
+ * @param endpoint The request path including the query string.
+ * @param token Abandons the request when cancelled.
+ * @param priority Order in which requests waiting for the limiter are sent.
+ * @return The response body, or std::nullopt if the request failed, was cancelled or was refused by the limiter.
+ */
+std::optional<std::string> OMDbApi::fetchBody(const std::string &cacheKey, const std::string &endpoint,
+                                              const CancellationToken &token, TaskPriority priority) {
+    if (std::optional<std::string> cached = responseCache.get(cacheKey)) {
+        return cached;
     }
-    // Parse the JSON response
-    try {
-        json response = json::parse(res->body);
-        std::cout << "DEBUG: Raw API Response: " << response.dump(2) << std::endl;
-        // Check if the response contains the 'Search' field
-        if (response.contains("Search")) {
-            // Iterate over each movie in the search results
-            for (const auto &movie: response["Search"]) {
-                std::string title = movie.value("Title", "Unknown");// Get movie title
-                std::string year = movie.value("Year", "Unknown");  // Get movie year
-                std::string imdbID = movie.value("imdbID", "");     // Get IMDb ID
-
-                std::string genre = "Unknown";     // Initialize genres
-                std::string imdbRating = "Unknown";// Initialize IMDb rating
-                // Fetch additional details for the movie
-                if (!imdbID.empty()) {
-                    std::string detailsEndpoint = "/?apikey=" + apiKey + "&i=" + imdbID;// Build the details endpoint URL
-                    std::cout << "DEBUG: Fetching details for " << title << " using " << detailsEndpoint << std::endl;
-                    // Send the request to fetch movie details
-                    auto detailsRes = client.Get(detailsEndpoint.c_str());
-                    // Check if the request was successful
-                    if (detailsRes && detailsRes->status == 200) {
-                        json detailsResponse = json::parse(detailsRes->body);       // Parse the JSON response
-                        genre = detailsResponse.value("Genre", "Unknown");          // Get movie genre
-                        imdbRating = detailsResponse.value("imdbRating", "Unknown");// Get IMDb rating
-                    } else {
-                        std::cerr << "ERROR: Failed to fetch details for IMDb ID: " << imdbID << std::endl;
-                    }
+
+    // Join an identical request another caller already has in flight; the request may outlive this call
+    return requestFlight.run(cacheKey, token, [this, cacheKey, endpoint, token, priority]() -> std::optional<std::string> {
+        // A caller retrying after a cancelled leader may find the response cached meanwhile
+        if (std::optional<std::string> cached = responseCache.get(cacheKey, false)) {
+            return cached;
+        }
+        for (int attempt = 1;; attempt++) {
+            if (!limiter.acquire(priority, token)) {
+                return std::nullopt;// Cancelled while waiting, or out of budget (logged by the limiter)
+            }
+            if (token.cancelled()) {
+                limiter.release(RequestLimiter::Outcome::Cancelled, std::chrono::steady_clock::duration::zero());
+                return std::nullopt;// Superseded just as the permit was granted; nothing was sent
+            }
+            auto sent = std::chrono::steady_clock::now();
+            auto res = apiHost.Get(endpoint, httplib::Headers(), token);
+            auto latency = std::chrono::steady_clock::now() - sent;
+
+            // Check if the request was successful
+            std::string failure;
+            if (!res) {
+                if (res.error() == httplib::Error::Canceled) {
+                    limiter.release(RequestLimiter::Outcome::Aborted, latency);
+                    return std::nullopt;// The search was superseded
                 }
+                failure = "Failed to connect to OMDb API";
+            } else if (res->body.find("\"Request limit reached!\"") != std::string::npos) {
+                // OMDb answers 401 once the key's daily quota is used up
+                limiter.release(RequestLimiter::Outcome::QuotaExhausted, latency);
+                std::cerr << "ERROR: OMDb API request limit reached." << std::endl;
+                return std::nullopt;
+            } else if (res->status == 429 || res->status >= 500) {
+                failure = "OMDb API returned HTTP " + std::to_string(res->status);
+            } else if (res->status != 200) {
+                // Check if the API returned an error
+                limiter.release(RequestLimiter::Outcome::Rejected, latency);
+                std::cerr << "ERROR: OMDb API returned HTTP " << res->status << std::endl;
+                return std::nullopt;
+            } else {
+                limiter.release(RequestLimiter::Outcome::Success, latency);
+                if (res->body.find("\"Response\":\"True\"") != std::string::npos) {
+                    responseCache.put(cacheKey, res->body);
+                }
+                return res->body;
+            }
 
-                // Download the movie poster and save it to the cache directory
-                std::string savePath = "cache/" + title + ".jpg";     // Build the save path
-                if (!DownloadImageFromURL(imdbID, savePath, apiKey)) {// Download the poster
-                    std::cerr << "ERROR: Failed to download poster for " << title << std::endl;
+            // Transient failure: back off and retry unless out of attempts
+            limiter.release(RequestLimiter::Outcome::Transient, latency);
+            if (attempt >= limiter.config().maxAttempts) {
+                std::cerr << "ERROR: " << failure << ", giving up after " << attempt << " attempts." << std::endl;
+                return std::nullopt;
+            }
+            auto delay = limiter.retryDelay(attempt - 1);
+            std::cerr << "ERROR: " << failure << ", retrying in " << delay.count() << " ms." << std::endl;
+            for (auto until = std::chrono::steady_clock::now() + delay; std::chrono::steady_clock::now() < until;) {
+                if (token.cancelled()) {
+                    return std::nullopt;
                 }
-                // Add the movie title to the vector
-                movieTitles.push_back(title + " (" + year + ")" + " (" + genre + ")" + " (" + imdbRating + ")" + "(" + imdbID + ")");
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(until - std::chrono::steady_clock::now(),
+                                                                                          std::chrono::milliseconds(20)));
             }
-        } else {
-            std::cerr << "ERROR: No 'Search' field in response. Full response: " << res->body << std::endl;
         }
-        // Check if the response contains the 'Error' field
-    } catch (const std::exception &e) {
-        std::cerr << "ERROR: Failed to parse JSON response: " << e.what() << std::endl;
-    }
-    // Return the vector of movie titles
-    return movieTitles;
+    }, priority);
 }
@@ -1,13 +1,31 @@
 #ifndef OMDB_API_H
 #define OMDB_API_H
 
+#include "HostConnectionPool.h"
+#include "Movie.h"
+#include "PosterCache.h"
+#include "RequestLimiter.h"
+#include "ResponseCache.h"
+#include "SingleFlight.h"
+#include "TaskScheduler.h"
+#include <functional>
 #include <httplib.h>
 #include <iostream>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <string>
 #include <vector>
 
 
+// Servers the API and the posters are fetched from; a local mock server in the benchmarks
+struct OMDbHosts {
+    std::string api = "www.omdbapi.com";
+    int apiPort = 80;
+    std::string image = "img.omdbapi.com";
+    int imagePort = 80;
+};
+
+
 /**
  * @class OMDbApi
  * @brief A class to interact with the OMDb API for movie information.
@@ -19,22 +37,108 @@
  * @brief Constructs an OMDbApi object with the given API key.
  *
  * @param apiKey The API key for accessing the OMDb API.
+ * @param scheduler Runs the detail and poster tasks; API requests themselves run on a network pool of 2 * limits.maxConcurrency threads.
+ * @param cachePath File holding the persistent cache of search and details responses; the daily request count is kept in omdb_usage.txt next to it.
+ * @param limits Request rate, daily budget, concurrency and retry settings for the OMDb API.
+ * @param hosts Servers of the API and the posters.
  */
 
 /**
  * @brief Searches for movies based on the given query.
  *
  * @param query The search query string.
- * @return A vector of movie titles that match the search query.
+ * @return The movies that match the search query, with details filled in.
+ */
+
+/**
+ * @brief Searches for movies and streams each result as soon as its details arrive.
+ *
+ * @param query The search query string.
+ * @param onMovie Called once per movie, from a fetch thread.
+ * @param onPoster Called once per movie with the local poster path (empty if unavailable), from a fetch thread.
+ * @param token Abandons the remaining requests when cancelled; no callbacks run after that.
+ */
+
+/**
+ * @brief Fetches one page (up to 10 movies) of search results, without details.
+ *
+ * @param query The search query string.
+ * @param page The 1-based result page.
+ * @param token Abandons the request when cancelled.
+ * @param priority Background requests wait for the more urgent ones and leave them a reserve of the daily budget.
+ * @return The page, or std::nullopt if the request failed or was cancelled.
+ */
+
+/**
+ * @brief Fetches the details and posters of movies returned by fetchSearchPage().
+ *
+ * @param movies The movies to complete.
+ * @param onMovie Called once per movie, from a fetch thread.
+ * @param onPoster Called once per movie with the local poster path (empty if unavailable), from a fetch thread.
+ * @param token Abandons the remaining requests when cancelled; no callbacks run after that.
+ * @param priority Scheduling class of the detail and poster requests.
+ */
+
+/**
+ * @brief Fetches one movie with its details by IMDb ID.
+ *
+ * @param imdbID The IMDb ID, e.g. "tt0076759".
+ * @param token Abandons the request when cancelled.
+ * @param priority Scheduling class of the request, see fetchSearchPage().
+ * @return The movie, or std::nullopt if OMDb does not know it or the request failed.
+ */
+
+/**
+ * @brief Returns the local path of a movie's poster, downloading it into the poster cache if needed.
+ *
+ * @param imdbID The IMDb ID of the movie.
+ * @param token Abandons the download when cancelled.
+ * @return The poster file, or an empty string if the movie has no poster or the download failed.
  */
 class OMDbApi {
 public:
-    explicit OMDbApi(const std::string& apiKey);
-    std::vector<std::string> searchMovies(const std::string& query);
+    using MovieCallback = std::function<void(const Movie&)>;
+    using PosterCallback = std::function<void(const std::string& imdbID, const std::string& posterPath)>;
+
+    struct SearchPage {
+        std::vector<Movie> movies;// Title, year, IMDb ID and poster URL only
+        int totalResults = 0;     // Matches across all pages, as reported by OMDb
+    };
+
+    OMDbApi(const std::string& apiKey, TaskScheduler& scheduler, const std::string& cachePath = "omdb_cache.bin",
+            const RequestLimiter::Config& limits = RequestLimiter::Config(), const OMDbHosts& hosts = OMDbHosts());
+    std::vector<Movie> searchMovies(const std::string& query);
+    void searchMovies(const std::string& query, const MovieCallback& onMovie, const PosterCallback& onPoster,
+                      const CancellationToken& token = CancellationToken());
+    std::optional<SearchPage> fetchSearchPage(const std::string& query, int page, const CancellationToken& token,
+                                              TaskPriority priority = TaskPriority::Current);
+    void completeMovies(const std::vector<Movie>& movies, const MovieCallback& onMovie, const PosterCallback& onPoster,
+                        const CancellationToken& token, TaskPriority priority = TaskPriority::Current);
+    std::optional<Movie> lookupMovie(const std::string& imdbID, const CancellationToken& token = CancellationToken(),
+                                     TaskPriority priority = TaskPriority::Current);
+    std::string fetchPoster(const std::string& imdbID, const CancellationToken& token = CancellationToken());
+    ResponseCache::Stats responseCacheStats() const;
+    SingleFlight<std::optional<std::string>>::Stats requestStats() const { return requestFlight.stats(); }
+    SingleFlight<std::string>::Stats posterStats() const { return posterFlight.stats(); }
+    RequestLimiter::State limiterState() const { return limiter.state(); }
 
 private:
+    Movie fetchMovieDetails(Movie movie, const CancellationToken& token, TaskPriority priority);
+    std::optional<std::string> fetchBody(const std::string& cacheKey, const std::string& endpoint,
+                                         const CancellationToken& token, TaskPriority priority);
+
     std::string apiKey;
-    httplib::Client client; // Using HTTP (no SSL needed)
+    ResponseCache responseCache;    // Persistent cache of search and details responses
+    PosterCache posterCache;        // Persistent poster store keyed by IMDb ID
+    TaskScheduler &scheduler;       // Runs detail and poster requests concurrently
+    RequestLimiter limiter;         // Rate, daily budget, concurrency and retries of the OMDb API requests
+    HostConnectionPool apiHost;     // Keep-alive connections to the API server, www.omdbapi.com (HTTP, no SSL needed), one per permit
+    HostConnectionPool imageHost;   // Keep-alive connections to the poster server, img.omdbapi.com
+    SingleFlight<std::optional<std::string>> requestFlight;// Shares identical OMDb requests in flight, keyed by cache key
+    SingleFlight<std::string> posterFlight;                // Shares poster fetches in flight, keyed by IMDb ID
+    // Runs the API requests, which may wait for the limiter or back off; twice the permits so urgent
+    // requests reach the limiter's priority lanes while others wait there. Declared last: stopped first.
+    TaskScheduler network;
 };
 
 #endif // OMDB_API_H
@@ -0,0 +1,163 @@
+#include "PagedSearch.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+
+/**
+ * @brief Constructs a search; nothing is fetched until start() is called.
+ *
+ * @param api The OMDb API used to fetch pages, details and posters.
+ * @param scheduler Runs the page requests.
+ * @param feed Receives the results.
+ * @param query The search query string.
+ * @param generation The generation ID returned by ResultFeed::beginSearch().
+ * @param catalog Local catalog searched before OMDb, or nullptr to always ask OMDb.
+ */
+PagedSearch::PagedSearch(OMDbApi &api, TaskScheduler &scheduler, ResultFeed &feed, std::string query, uint64_t generation,
+                         const LocalCatalog *catalog)
+    : api(api), scheduler(scheduler), feed(feed), query(std::move(query)), generation(generation), catalog(catalog) {}
+
+/**
+ * @brief Fetches the first page.
+ */
+void PagedSearch::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    requestPage(TaskPriority::Current);
+}
+
+/**
+ * @brief Fetches more pages once the user has scrolled close to the end of the list.
+ *
+ * Called by the main loop every frame. A page is fetched in the background
+ * while the one before it is on screen; if the user reaches the last row
+ * before it arrives, the fetch counts as one the user is waiting for.
+ *
+ * @param visibleRows Number of rows the user has scrolled through.
+ */
+void PagedSearch::ensureRows(size_t visibleRows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pageCount == 0 || token.cancelled()) {
+        return;// The first page has not arrived yet
+    }
+    // Keep one page ahead of the rows the user has reached
+    while (nextPage <= pageCount && visibleRows + kPageSize >= static_cast<size_t>(nextPage - 1) * kPageSize) {
+        requestPage(visibleRows >= published ? TaskPriority::Current : TaskPriority::Background);
+    }
+}
+
+// Queue the fetch of the next page; must be called with the mutex held
+void PagedSearch::requestPage(TaskPriority priority) {
+    int page = nextPage++;
+    if (priority != TaskPriority::Background && waitingPages++ == 0) {
+        feed.setSearching(generation, true);
+    }
+    scheduler.submit(priority, [self = shared_from_this(), page, priority]() {
+        self->loadPage(page, priority);
+    });
+}
+
+// Task: fetch one page, publish its new movies and their details and posters
+void PagedSearch::loadPage(int page, TaskPriority priority) {
+    std::optional<OMDbApi::SearchPage> result;
+    if (!token.cancelled()) {
+        if (page == 1 && catalog) {
+            localResults = catalog->search(query, kPageSize * kMaxPages);
+            // A misspelled query would find nothing on OMDb either, so correct it locally
+            if (localResults.empty()) {
+                localResults = catalog->searchFuzzy(query, kPageSize * kMaxPages);
+            }
+        }
+        // Only go to OMDb when the catalog has no match
+        result = localResults.empty() ? api.fetchSearchPage(query, page, token, priority) : localPage(page);
+    }
+
+    std::vector<Movie> fresh;// Movies not listed on an earlier page
+    if (result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (page == 1) {
+            int pages = (result->totalResults + kPageSize - 1) / kPageSize;
+            pageCount = std::min(pages, kMaxPages);
+            // Prefetch the second page while the first one is on screen
+            if (pageCount > 1 && !token.cancelled()) {
+                requestPage(TaskPriority::Background);
+            }
+        }
+        for (Movie &movie: result->movies) {
+            if (seen.insert(movie.imdbID).second) {
+                fresh.push_back(std::move(movie));
+            }
+        }
+    }
+    if (result && page == 1) {
+        feed.setTotalResults(generation, result->totalResults);
+    }
+
+    // The user stops waiting once the page's movies are listed, not when its last poster arrives
+    std::atomic<size_t> detailsLeft{fresh.size()};
+    std::atomic<bool> listed{false};
+    auto pageListed = [this, priority, &listed]() {
+        if (!listed.exchange(true)) {
+            finishWaiting(priority);
+        }
+    };
+    if (fresh.empty()) {
+        pageListed();
+    }
+
+    // Publish each movie as soon as its details arrive
+    api.completeMovies(
+            fresh,
+            [this, &detailsLeft, &pageListed](const Movie &movie) {
+                feed.publishMovie(generation, movie);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    published++;
+                }
+                if (--detailsLeft == 0) {
+                    pageListed();
+                }
+            },
+            [this](const std::string &imdbID, const std::string &posterPath) {
+                if (!posterPath.empty()) {
+                    feed.publishPoster(generation, imdbID, posterPath);
+                }
+            },
+            token, priority);
+    pageListed();// Detail requests abandoned on cancellation never call back
+
+    int pages;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pages = pageCount;
+    }
+    if (token.cancelled()) {
+        return;
+    }
+
+    // Check if any movies were found
+    if (page == 1 && fresh.empty()) {
+        std::cerr << " No movies found for query: " << query << std::endl;
+    } else {
+        std::cout << " Received " << fresh.size() << " movies from page " << page << " of " << pages
+                  << (localResults.empty() ? "" : " (local catalog)") << std::endl;
+    }
+}
+
+// A requested page has been listed; hide "Searching..." once the user waits for no other page
+void PagedSearch::finishWaiting(TaskPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (priority != TaskPriority::Background && --waitingPages == 0) {
+        feed.setSearching(generation, false);
+    }
+}
+
+// One page of the catalog matches, shaped like an OMDb search page
+OMDbApi::SearchPage PagedSearch::localPage(int page) const {
+    OMDbApi::SearchPage result;
+    size_t begin = std::min(localResults.size(), static_cast<size_t>(page - 1) * kPageSize);
+    size_t end = std::min(localResults.size(), begin + kPageSize);
+    result.movies.assign(localResults.begin() + begin, localResults.begin() + end);
+    result.totalResults = static_cast<int>(localResults.size());
+    return result;
+}
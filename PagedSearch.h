@@ -0,0 +1,68 @@
+#ifndef PAGED_SEARCH_H
+#define PAGED_SEARCH_H
+
+#include "CancellationToken.h"
+#include "LocalCatalog.h"
+#include "OMDbApi.h"
+#include "ResultFeed.h"
+#include "TaskScheduler.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+
+/**
+ * @class PagedSearch
+ * @brief One search query, fetched from OMDb a page at a time as the user scrolls.
+ *
+ * The first page is fetched right away and the second is prefetched in the
+ * background as soon as the first arrives. After that, the search stays one
+ * page ahead of the rows the user has scrolled through. Movies OMDb lists on
+ * more than one page are only published once. Results go to the ResultFeed
+ * under the search's generation ID.
+ *
+ * With a local catalog, the query is answered from the catalog instead, with
+ * typos corrected if it has no exact match, and OMDb is only asked when the
+ * catalog has nothing close. Catalog results are
+ * handed out in pages of the same size, so posters are still only fetched
+ * for the rows the user scrolls to.
+ */
+class PagedSearch : public std::enable_shared_from_this<PagedSearch> {
+public:
+    static constexpr int kPageSize = 10; // Movies per OMDb search page
+    static constexpr int kMaxPages = 100;// OMDb serves no pages past 100
+
+    PagedSearch(OMDbApi &api, TaskScheduler &scheduler, ResultFeed &feed, std::string query, uint64_t generation,
+                const LocalCatalog *catalog = nullptr);
+
+    void start();
+    void ensureRows(size_t visibleRows);
+    void cancel() { token.cancel(); }
+
+private:
+    void requestPage(TaskPriority priority);
+    void loadPage(int page, TaskPriority priority);
+    void finishWaiting(TaskPriority priority);
+    OMDbApi::SearchPage localPage(int page) const;
+
+    OMDbApi &api;
+    TaskScheduler &scheduler;
+    ResultFeed &feed;
+    std::string query;
+    uint64_t generation;
+    const LocalCatalog *catalog;// Searched before OMDb, may be nullptr
+    CancellationToken token;
+    std::vector<Movie> localResults;// Catalog matches; written by the first page's task before any other page is requested
+
+    std::mutex mutex;
+    int pageCount = 0;                   // Pages OMDb has for the query, 0 until the first page arrives
+    int nextPage = 1;                    // Next page to request
+    int waitingPages = 0;                // Requested pages the user is waiting for
+    size_t published = 0;                // Movies handed to the feed
+    std::unordered_set<std::string> seen;// IMDb IDs already listed
+};
+
+#endif // PAGED_SEARCH_H
@@ -0,0 +1,314 @@
+#include "PosterCache.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char kIndexHeader[] = "# poster-cache v1";
+    const int kIndexSaveEvery = 32;        // Downloads recorded before the index is rewritten
+    const int64_t kIndexSaveInterval = 30; // Seconds after which a download is recorded anyway
+
+    int64_t unixNow() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}// namespace
+
+
+/**
+ * @brief Opens the poster store, creating the directory if needed.
+ *
+ * Leftover partial downloads are deleted and index entries whose file is
+ * missing or has the wrong size are dropped.
+ *
+ * @param directory Directory holding the posters and the index file.
+ * @param maxBytes Size budget of all posters together.
+ * @param revalidateAfter Age after which a poster is revalidated with the server.
+ */
+PosterCache::PosterCache(const std::string &directory, uint64_t maxBytes, std::chrono::seconds revalidateAfter)
+    : directory(directory), indexPath(directory + "/index.txt"), maxBytes(maxBytes), revalidateAfter(revalidateAfter) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not create poster cache directory " << directory << ": " << ec.message() << std::endl;
+    }
+    // Remove downloads that were interrupted before their rename
+    for (const auto &file: fs::directory_iterator(directory, ec)) {
+        if (file.path().filename().string().find(".part") != std::string::npos) {
+            fs::remove(file.path(), ec);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    loadIndex();
+    evict("");
+}
+
+PosterCache::~PosterCache() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (indexDirty) {
+        saveIndex();// Persist access times for LRU eviction in the next session
+    }
+}
+
+/**
+ * @brief Returns the local path of a movie's poster, downloading it if needed.
+ *
+ * Fresh posters are served from disk without network traffic. Stale
+ * posters are revalidated with If-None-Match / If-Modified-Since and only
+ * downloaded again if they changed; if the server cannot be reached the
+ * stale copy is still served. Safe to call from several threads.
+ *
+ * @param imageHost Connection pool for img.omdbapi.com.
+ * @param imdbID The IMDb ID of the movie.
+ * @param apiKey The API key for accessing the OMDb API.
+ * @param token Abandons the download when cancelled.
+ * @return The path of the poster file, or an empty string if there is none.
+ */
+std::string PosterCache::fetch(HostConnectionPool &imageHost, const std::string &imdbID, const std::string &apiKey,
+                               const CancellationToken &token) {
+    if (imdbID.empty()) {
+        return "";
+    }
+    std::string path = pathFor(imdbID);
+    int64_t now = unixNow();
+    bool haveCopy = false;
+    httplib::Headers conditions;// Validators for a conditional GET
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(imdbID);
+        if (it != entries.end()) {
+            Entry &entry = it->second;
+            if (now - entry.fetchedAt < revalidateAfter.count()) {
+                touch(entry, now);
+                return path;
+            }
+            haveCopy = true;
+            if (!entry.etag.empty()) conditions.emplace("If-None-Match", entry.etag);
+            if (!entry.lastModified.empty()) conditions.emplace("If-Modified-Since", entry.lastModified);
+        }
+    }
+
+    std::cout << "Downloading poster for IMDb ID: " << imdbID << " -> " << path << std::endl;
+    // Construct the URL for downloading the image using the IMDb ID and API key
+    std::string imageUrl = "/?apikey=" + apiKey + "&i=" + imdbID;
+    auto res = imageHost.Get(imageUrl, conditions, token);
+    // Check if response was successful
+    if (!res) {
+        if (res.error() != httplib::Error::Canceled) {
+            std::cerr << "ERROR: No response from server." << std::endl;
+        }
+        return haveCopy ? path : "";
+    }
+
+    if (res->status == 304 && haveCopy) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(imdbID);
+        if (it == entries.end()) {
+            return "";// Evicted while revalidating
+        }
+        it->second.fetchedAt = now;
+        touch(it->second, now);
+        return path;
+    }
+
+    if (res->status != 200) {
+        std::cerr << "ERROR: Server returned status " << res->status << std::endl;
+        return haveCopy ? path : "";
+    }
+
+    // Write to a unique temporary file, then atomically rename it into place
+    std::string tempPath = path + ".part" + std::to_string(tempCounter.fetch_add(1));
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "ERROR: Could not open file for writing: " << tempPath << std::endl;
+            return haveCopy ? path : "";
+        }
+        file.write(res->body.data(), static_cast<std::streamsize>(res->body.size()));
+        if (!file.flush()) {
+            std::cerr << "ERROR: Could not write poster: " << tempPath << std::endl;
+            file.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return haveCopy ? path : "";
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not move poster into place: " << path << ": " << ec.message() << std::endl;
+        fs::remove(tempPath, ec);
+        return haveCopy ? path : "";
+    }
+
+    auto [it, inserted] = entries.try_emplace(imdbID);
+    Entry &entry = it->second;
+    if (!inserted) {
+        totalBytes -= entry.bytes;
+        lru.erase(entry.lru);
+    }
+    lru.push_front(imdbID);
+    entry.lru = lru.begin();
+    entry.bytes = res->body.size();
+    entry.lastAccess = now;
+    entry.fetchedAt = now;
+    entry.etag = res->get_header_value("ETag");
+    entry.lastModified = res->get_header_value("Last-Modified");
+    totalBytes += entry.bytes;
+
+    evict(imdbID);
+    // Rewriting the whole index blocks every other poster lookup, so downloads are recorded in batches
+    unsavedDownloads++;
+    if (unsavedDownloads >= kIndexSaveEvery || now - indexSavedAt >= kIndexSaveInterval) {
+        saveIndex();
+    }
+    return path;
+}
+
+/**
+ * @brief Returns where a poster cache in the given directory stores the poster of a movie.
+ *
+ * Only letters and digits of the IMDb ID are used, so the path is always valid.
+ *
+ * @param directory The poster cache directory.
+ * @param imdbID The IMDb ID of the movie.
+ * @return The poster file path.
+ */
+std::string PosterCache::pathIn(const std::string &directory, const std::string &imdbID) {
+    std::string name;
+    for (unsigned char c: imdbID) {
+        if (std::isalnum(c)) name += static_cast<char>(c);
+    }
+    return directory + "/" + name + ".jpg";
+}
+
+// Read the index file; entries whose poster is missing or truncated are skipped
+void PosterCache::loadIndex() {
+    indexSavedAt = unixNow();
+    std::vector<std::pair<int64_t, std::string>> byAccess;
+    std::ifstream in(indexPath);
+    std::string line;
+    if (in && (!std::getline(in, line) || line != kIndexHeader)) {
+        std::cerr << "Warning: Ignoring unknown poster cache index " << indexPath << std::endl;
+        in.close();
+    }
+    while (in.is_open() && std::getline(in, line)) {
+        // imdbID \t bytes \t lastAccess \t fetchedAt \t etag \t lastModified
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) fields.push_back(field);
+        if (fields.size() < 4) continue;
+        fields.resize(6);
+
+        Entry entry;
+        try {
+            entry.bytes = std::stoull(fields[1]);
+            entry.lastAccess = std::stoll(fields[2]);
+            entry.fetchedAt = std::stoll(fields[3]);
+        } catch (const std::exception &) {
+            continue;
+        }
+        entry.etag = fields[4];
+        entry.lastModified = fields[5];
+
+        std::error_code ec;
+        if (fs::file_size(pathFor(fields[0]), ec) != entry.bytes || ec) {
+            indexDirty = true;
+            continue;
+        }
+        byAccess.emplace_back(entry.lastAccess, fields[0]);
+        entries[fields[0]] = std::move(entry);
+    }
+
+    // Posters downloaded after the last index save, e.g. before a crash, are adopted as of their file time
+    std::error_code ec;
+    for (const auto &file: fs::directory_iterator(directory, ec)) {
+        std::string imdbID = file.path().stem().string();
+        if (file.path().extension() != ".jpg" || entries.count(imdbID)) {
+            continue;
+        }
+        Entry entry;
+        entry.bytes = file.file_size(ec);
+        auto modified = file.last_write_time(ec);
+        if (ec) {
+            continue;
+        }
+        entry.lastAccess = std::chrono::duration_cast<std::chrono::seconds>(
+                                   std::chrono::file_clock::to_sys(modified).time_since_epoch())
+                                   .count();
+        entry.fetchedAt = entry.lastAccess;
+        byAccess.emplace_back(entry.lastAccess, imdbID);
+        entries[imdbID] = std::move(entry);
+        indexDirty = true;
+    }
+
+    // Rebuild the LRU order from the recorded access times, oldest at the back
+    std::sort(byAccess.begin(), byAccess.end());
+    for (const auto &[lastAccess, imdbID]: byAccess) {
+        Entry &entry = entries[imdbID];
+        lru.push_front(imdbID);
+        entry.lru = lru.begin();
+        totalBytes += entry.bytes;
+    }
+}
+
+// Rewrite the index file through a temporary file and rename
+void PosterCache::saveIndex() {
+    std::string tempPath = indexPath + ".part";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out) {
+            std::cerr << "ERROR: Could not write poster cache index " << tempPath << std::endl;
+            return;
+        }
+        out << kIndexHeader << "\n";
+        for (const auto &[imdbID, entry]: entries) {
+            out << imdbID << '\t' << entry.bytes << '\t' << entry.lastAccess << '\t' << entry.fetchedAt << '\t'
+                << entry.etag << '\t' << entry.lastModified << "\n";
+        }
+        if (!out.flush()) {
+            std::cerr << "ERROR: Could not write poster cache index " << tempPath << std::endl;
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, indexPath, ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not replace poster cache index " << indexPath << ": " << ec.message() << std::endl;
+        return;
+    }
+    indexDirty = false;
+    unsavedDownloads = 0;
+    indexSavedAt = unixNow();
+}
+
+void PosterCache::touch(Entry &entry, int64_t now) {
+    entry.lastAccess = now;
+    lru.splice(lru.begin(), lru, entry.lru);
+    indexDirty = true;
+}
+
+// Delete least recently used posters until the store fits its budget, never deleting `keep`
+void PosterCache::evict(const std::string &keep) {
+    while (totalBytes > maxBytes && !lru.empty() && lru.back() != keep) {
+        std::string imdbID = lru.back();
+        auto it = entries.find(imdbID);
+        std::error_code ec;
+        fs::path path = pathFor(imdbID);
+        fs::remove(path, ec);
+        fs::remove(path.replace_extension(".thumb"), ec);// Display-size thumbnail made by the GUI
+        totalBytes -= it->second.bytes;
+        lru.pop_back();
+        entries.erase(it);
+        indexDirty = true;
+    }
+}
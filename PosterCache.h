@@ -0,0 +1,75 @@
+#ifndef POSTER_CACHE_H
+#define POSTER_CACHE_H
+
+#include "HostConnectionPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+/**
+ * @class PosterCache
+ * @brief A persistent on-disk store of poster images keyed by IMDb ID.
+ *
+ * Posters are saved as <directory>/<imdbID>.jpg and survive restarts; the
+ * GUI stores a display-size <imdbID>.thumb next to each poster, which is
+ * deleted together with it. An
+ * index file records each poster's size, last access time and the HTTP
+ * validators (ETag / Last-Modified) it was served with. Fresh posters are
+ * served without any network traffic; stale ones are revalidated with a
+ * conditional GET. Files are written to a temporary name and renamed into
+ * place, so a crash never leaves a truncated poster behind. The index is
+ * rewritten after a batch of downloads and on destruction; posters missing
+ * from it after a crash are picked up again on the next start. When the store
+ * exceeds its size budget, the least recently used posters are deleted.
+ */
+class PosterCache {
+public:
+    explicit PosterCache(const std::string &directory = "cache/posters",
+                         uint64_t maxBytes = 64 * 1024 * 1024,
+                         std::chrono::seconds revalidateAfter = std::chrono::hours(24 * 7));
+    ~PosterCache();
+
+    PosterCache(const PosterCache &) = delete;
+    PosterCache &operator=(const PosterCache &) = delete;
+
+    std::string fetch(HostConnectionPool &imageHost, const std::string &imdbID, const std::string &apiKey,
+                      const CancellationToken &token = CancellationToken());
+    std::string pathFor(const std::string &imdbID) const { return pathIn(directory, imdbID); }
+    static std::string pathIn(const std::string &directory, const std::string &imdbID);
+
+private:
+    struct Entry {
+        uint64_t bytes = 0;
+        int64_t lastAccess = 0;// Unix time the poster was last served
+        int64_t fetchedAt = 0; // Unix time the poster was last downloaded or revalidated
+        std::string etag;
+        std::string lastModified;
+        std::list<std::string>::iterator lru;
+    };
+
+    void loadIndex();
+    void saveIndex();
+    void touch(Entry &entry, int64_t now);
+    void evict(const std::string &keep);
+
+    std::string directory;
+    std::string indexPath;
+    uint64_t maxBytes;
+    std::chrono::seconds revalidateAfter;
+
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru;// Most recently used IMDb IDs first
+    uint64_t totalBytes = 0;
+    bool indexDirty = false;
+    int unsavedDownloads = 0;// Downloads since the index was last written
+    int64_t indexSavedAt = 0;// Unix time the index was last written
+    std::atomic<uint64_t> tempCounter{0};// Unique suffix for in-progress downloads
+    std::mutex mutex;
+};
+
+#endif // POSTER_CACHE_H
@@ -0,0 +1,263 @@
+#include "RequestLimiter.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+// Usage file: this header, then "<days since the epoch> <requests sent that day> <1 if the API refused more>"
+static const char *kUsageHeader = "# omdb-usage v1";
+
+
+/**
+ * @brief Creates a limiter with a full token bucket and the maximum concurrency.
+ *
+ * @param config Rate, budget, concurrency and retry settings.
+ * @param usagePath File the day's request count is kept in, or empty to count in this process only.
+ */
+RequestLimiter::RequestLimiter(const Config &config, const std::string &usagePath)
+    : limits(config), usagePath(usagePath), tokens(std::max(config.burst, 1.0)), refilledAt(Clock::now()),
+      concurrencyLimit(static_cast<double>(std::max(config.maxConcurrency, config.minConcurrency))),
+      decreasedAt(Clock::now() - config.latencyTarget),
+      random(static_cast<unsigned>(Clock::now().time_since_epoch().count())) {
+    limits.minConcurrency = std::max<size_t>(limits.minConcurrency, 1);
+    limits.maxConcurrency = std::max(limits.maxConcurrency, limits.minConcurrency);
+    limits.perSecond = std::max(limits.perSecond, 0.001);
+    limits.burst = std::max(limits.burst, 1.0);
+    limits.maxAttempts = std::max(limits.maxAttempts, 1);
+    std::lock_guard<std::mutex> lock(mutex);
+    rollDay();
+    readUsage();
+}
+
+/**
+ * @brief Waits for a permit to send one request.
+ *
+ * @param priority Requests of a more urgent priority that are waiting go first.
+ * @param token Gives up waiting when cancelled.
+ * @return true with a permit that must be given back with release(), false if
+ *         the request was cancelled or is out of budget.
+ */
+bool RequestLimiter::acquire(TaskPriority priority, const CancellationToken &token) {
+    size_t lane = static_cast<size_t>(priority);
+    std::unique_lock<std::mutex> lock(mutex);
+    waiting[lane]++;
+    bool waited = false;
+    while (true) {
+        rollDay();
+        if (token.cancelled() || outOfBudget(priority)) {
+            waiting[lane]--;
+            changed.notify_all();// Lower priorities may no longer have to wait for this request
+            return false;
+        }
+        Clock::time_point now = Clock::now();
+        refill(now);
+        bool urgentWaiting = std::any_of(waiting.begin(), waiting.begin() + lane, [](size_t count) { return count > 0; });
+        bool slotFree = inFlight < static_cast<size_t>(concurrencyLimit);
+        if (!urgentWaiting && slotFree && tokens >= 1.0) {
+            // Other processes sharing the usage file may have used some of the budget meanwhile
+            readUsage();
+            if (outOfBudget(priority)) {
+                waiting[lane]--;
+                changed.notify_all();
+                return false;
+            }
+            tokens -= 1.0;
+            inFlight++;
+            usedToday++;
+            writeUsage();
+            granted++;
+            waiting[lane]--;
+            if (waited) {
+                throttled++;
+            }
+            changed.notify_all();
+            return true;
+        }
+        waited = true;
+        // Sleep until the next token is due, a permit is released, or briefly to notice cancellation
+        Clock::time_point wake = now + std::chrono::milliseconds(50);
+        if (tokens < 1.0 && !urgentWaiting && slotFree) {
+            auto refillTime = std::chrono::duration<double>((1.0 - tokens) / limits.perSecond);
+            wake = std::min(wake, now + std::chrono::duration_cast<Clock::duration>(refillTime));
+        }
+        changed.wait_until(lock, wake);
+    }
+}
+
+/**
+ * @brief Gives back a permit and adapts the concurrency limit to the request's outcome.
+ *
+ * @param outcome How the request ended.
+ * @param latency Time from sending the request to its response.
+ */
+void RequestLimiter::release(Outcome outcome, std::chrono::steady_clock::duration latency) {
+    std::lock_guard<std::mutex> lock(mutex);
+    inFlight--;
+    Clock::time_point now = Clock::now();
+    switch (outcome) {
+        case Outcome::Success:
+            if (latency > limits.latencyTarget) {
+                decrease(now);
+            } else {
+                // Additive increase: one more slot after a full window of successful requests
+                concurrencyLimit = std::min(static_cast<double>(limits.maxConcurrency), concurrencyLimit + 1.0 / concurrencyLimit);
+            }
+            break;
+        case Outcome::Transient:
+            transientErrors++;
+            decrease(now);
+            break;
+        case Outcome::QuotaExhausted:
+            readUsage();
+            quotaExhausted = true;
+            writeUsage();
+            break;
+        case Outcome::Cancelled:
+            // Never sent, so give the budget back
+            rollDay();
+            readUsage();
+            if (usedToday > 0) {
+                usedToday--;
+            }
+            writeUsage();
+            break;
+        case Outcome::Rejected:
+        case Outcome::Aborted:
+            break;
+    }
+    changed.notify_all();
+}
+
+/**
+ * @brief Returns how long to wait before retrying a transient failure.
+ *
+ * Full jitter: a random delay up to retryBase * 2^attempt, capped at retryMax.
+ *
+ * @param attempt 0 for the first retry.
+ * @return The delay.
+ */
+std::chrono::milliseconds RequestLimiter::retryDelay(int attempt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    retries++;
+    double ceiling = std::min(static_cast<double>(limits.retryMax.count()),
+                              static_cast<double>(limits.retryBase.count()) * std::ldexp(1.0, std::min(attempt, 30)));
+    std::uniform_real_distribution<double> jitter(0.0, ceiling);
+    return std::chrono::milliseconds(static_cast<int64_t>(jitter(random)));
+}
+
+/**
+ * @brief Returns a snapshot of the limiter, e.g. to see whether requests are being throttled.
+ */
+RequestLimiter::State RequestLimiter::state() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    State state;
+    state.concurrencyLimit = concurrencyLimit;
+    state.inFlight = inFlight;
+    for (size_t count: waiting) {
+        state.waiting += count;
+    }
+    // The bucket as it would be now, without touching it
+    double elapsed = std::chrono::duration<double>(Clock::now() - refilledAt).count();
+    state.tokens = std::min(limits.burst, tokens + elapsed * limits.perSecond);
+    state.usedToday = usedToday;
+    state.dailyBudget = limits.perDay;
+    state.quotaExhausted = quotaExhausted || (limits.perDay != 0 && usedToday >= limits.perDay);
+    state.granted = granted;
+    state.throttled = throttled;
+    state.refused = refused;
+    state.retries = retries;
+    state.transientErrors = transientErrors;
+    return state;
+}
+
+// Add the tokens earned since the last refill
+void RequestLimiter::refill(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - refilledAt).count();
+    tokens = std::min(limits.burst, tokens + elapsed * limits.perSecond);
+    refilledAt = now;
+}
+
+// Start a new daily budget at midnight UTC
+void RequestLimiter::rollDay() {
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    int64_t today = std::chrono::duration_cast<std::chrono::hours>(sinceEpoch).count() / 24;
+    if (today != day) {
+        day = today;
+        usedToday = 0;
+        quotaExhausted = false;
+        exhaustionLogged = false;
+    }
+}
+
+// Take the day's count from the usage file, if it has one for today
+void RequestLimiter::readUsage() {
+    if (usagePath.empty()) {
+        return;
+    }
+    std::ifstream in(usagePath);
+    std::string header;
+    int64_t fileDay = 0;
+    uint64_t used = 0;
+    int exhausted = 0;
+    if (!std::getline(in, header) || header != kUsageHeader || !(in >> fileDay >> used >> exhausted)) {
+        return;// Not written yet, or unreadable: keep counting from this process's count
+    }
+    if (fileDay == day) {
+        usedToday = used;
+        quotaExhausted = quotaExhausted || exhausted != 0;
+    }
+}
+
+// Record the day's count in the usage file, through a temporary file and rename
+void RequestLimiter::writeUsage() {
+    if (usagePath.empty()) {
+        return;
+    }
+    std::string tempPath = usagePath + ".part" + std::to_string(random());// Unique per writer
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        out << kUsageHeader << "\n" << day << ' ' << usedToday << ' ' << (quotaExhausted ? 1 : 0) << "\n";
+        if (!out.flush()) {
+            std::cerr << "ERROR: Could not write request usage " << tempPath << std::endl;
+            out.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, usagePath, ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not replace request usage " << usagePath << ": " << ec.message() << std::endl;
+        fs::remove(tempPath, ec);
+    }
+}
+
+// Whether the request must be refused: the quota is used up, or only the reserve for urgent requests is left
+bool RequestLimiter::outOfBudget(TaskPriority priority) {
+    bool exhausted = quotaExhausted || (limits.perDay != 0 && usedToday >= limits.perDay);
+    if (exhausted && !exhaustionLogged) {
+        std::cerr << "ERROR: Request budget exhausted (" << usedToday << " requests today), requests are refused until midnight UTC" << std::endl;
+        exhaustionLogged = true;
+    }
+    if (!exhausted && priority == TaskPriority::Background && limits.perDay != 0) {
+        auto reserve = static_cast<uint64_t>(static_cast<double>(limits.perDay) * limits.backgroundReserve);
+        exhausted = usedToday + reserve >= limits.perDay;
+    }
+    if (exhausted) {
+        refused++;
+    }
+    return exhausted;
+}
+
+// Multiplicative decrease, once per latency target so one burst of failures halves the limit only once
+void RequestLimiter::decrease(Clock::time_point now) {
+    if (now - decreasedAt < limits.latencyTarget) {
+        return;
+    }
+    concurrencyLimit = std::max(static_cast<double>(limits.minConcurrency), concurrencyLimit / 2.0);
+    decreasedAt = now;
+}
@@ -0,0 +1,130 @@
+#ifndef REQUEST_LIMITER_H
+#define REQUEST_LIMITER_H
+
+#include "CancellationToken.h"
+#include "TaskScheduler.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+
+
+/**
+ * @class RequestLimiter
+ * @brief Paces the requests to a rate-limited API and adapts their concurrency.
+ *
+ * Every request must acquire() a permit before it is sent and release() it
+ * with its outcome afterwards. A permit needs:
+ * - a token from a bucket refilled at perSecond (up to burst tokens), so
+ *   bursts of requests are smoothed out;
+ * - room in the daily budget. Background requests leave the last
+ *   backgroundReserve of it to the requests the user is waiting for. Once
+ *   the budget is used up, or the API reports its own limit as reached,
+ *   requests fail fast until the next day (UTC). With a usage file, the
+ *   day's count is kept there, so it survives restarts and is shared by
+ *   every process using the same file. Permits given back unsent are not
+ *   charged;
+ * - a free slot under the concurrency limit. The limit grows by one per
+ *   limit successful requests (additive increase) and is halved when a
+ *   request fails transiently or is slower than latencyTarget
+ *   (multiplicative decrease), at most once per latencyTarget.
+ * Waiting requests are granted in priority order, so a search the user is
+ * waiting for goes before prefetching queued earlier.
+ *
+ * retryDelay() gives the delay before retrying a transient failure:
+ * exponential backoff with full jitter, so clients failing together do not
+ * retry together.
+ *
+ * Thread-safe.
+ */
+class RequestLimiter {
+public:
+    struct Config {
+        double perSecond = 10.0;   // Sustained request rate
+        double burst = 10.0;       // Requests that may be sent at once after a quiet period
+        uint64_t perDay = 1000;    // Daily budget, 0 for none (OMDb's free keys allow 1000 requests a day)
+        double backgroundReserve = 0.1;// Share of the daily budget background requests may not use
+        size_t minConcurrency = 1;
+        size_t maxConcurrency = 8;
+        std::chrono::milliseconds latencyTarget{2000};// Slower responses count as congestion
+        int maxAttempts = 3;                          // Attempts per request, including the first
+        std::chrono::milliseconds retryBase{250};     // Backoff before the first retry, doubled for each further one
+        std::chrono::milliseconds retryMax{8000};
+    };
+
+    // How a request ended, which drives the concurrency limit
+    enum class Outcome {
+        Success,       // Answered, including answers such as "Movie not found!"
+        Transient,     // Connection error, timeout, HTTP 429 or 5xx; worth retrying
+        Rejected,      // Another HTTP error; retrying would not help
+        QuotaExhausted,// The API refuses requests until its daily limit resets
+        Cancelled,     // Abandoned by the caller before the request was sent; not charged to the daily budget
+        Aborted,       // Abandoned by the caller after the request was sent
+    };
+
+    struct State {
+        double concurrencyLimit = 0.0;
+        size_t inFlight = 0;
+        size_t waiting = 0;         // Requests waiting for a permit
+        double tokens = 0.0;        // Tokens left in the per-second bucket
+        uint64_t usedToday = 0;     // Requests sent since midnight UTC, by every process sharing the usage file
+        uint64_t dailyBudget = 0;   // 0 if unlimited
+        bool quotaExhausted = false;// Requests fail until midnight UTC
+        uint64_t granted = 0;       // Permits granted in total
+        uint64_t throttled = 0;     // Permits that had to wait for a token, a slot or a higher priority
+        uint64_t refused = 0;       // Requests refused for lack of budget
+        uint64_t retries = 0;
+        uint64_t transientErrors = 0;
+    };
+
+    explicit RequestLimiter(const Config &config, const std::string &usagePath = "");
+
+    RequestLimiter(const RequestLimiter &) = delete;
+    RequestLimiter &operator=(const RequestLimiter &) = delete;
+
+    bool acquire(TaskPriority priority, const CancellationToken &token);
+    void release(Outcome outcome, std::chrono::steady_clock::duration latency);
+    std::chrono::milliseconds retryDelay(int attempt);
+    const Config &config() const { return limits; }
+    State state() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void refill(Clock::time_point now);
+    void rollDay();
+    void readUsage();
+    void writeUsage();
+    bool outOfBudget(TaskPriority priority);
+    void decrease(Clock::time_point now);
+
+    Config limits;
+    std::string usagePath;// The day's usage, shared across restarts and processes; empty to count in memory only
+    mutable std::mutex mutex;
+    std::condition_variable changed;// A permit was released, a waiter left, or the limit grew
+
+    double tokens;
+    Clock::time_point refilledAt;
+    double concurrencyLimit;
+    Clock::time_point decreasedAt;// Last multiplicative decrease
+    size_t inFlight = 0;
+    std::array<size_t, 3> waiting{};// Waiting requests per TaskPriority
+
+    int64_t day = 0;              // Days since the epoch (UTC) the counters below belong to
+    uint64_t usedToday = 0;
+    bool quotaExhausted = false;
+    bool exhaustionLogged = false;
+
+    uint64_t granted = 0;
+    uint64_t throttled = 0;
+    uint64_t refused = 0;
+    uint64_t retries = 0;
+    uint64_t transientErrors = 0;
+    std::minstd_rand random;// Retry jitter
+};
+
+#endif // REQUEST_LIMITER_H
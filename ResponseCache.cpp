@@ -0,0 +1,333 @@
+#include "ResponseCache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char kMagic[8] = {'O', 'M', 'D', 'B', 'R', 'C', '0', '1'};
+
+    // Header written in front of every key/value pair
+    struct RecordHeader {
+        uint32_t keySize;
+        uint32_t valueSize;
+        int64_t storedAt;
+    };
+
+    int64_t unixNow() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}// namespace
+
+
+/**
+ * @brief Opens the cache file, creating it if needed, and rebuilds the index.
+ *
+ * @param path Path of the cache file.
+ * @param ttl How long a stored response stays valid.
+ * @param maxBytes Maximum size of the live entries before LRU eviction.
+ */
+ResponseCache::ResponseCache(const std::string &path, std::chrono::seconds ttl, size_t maxBytes)
+    : path(path), ttl(ttl), maxBytes(maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    load();
+}
+
+ResponseCache::~ResponseCache() {
+    std::lock_guard<std::mutex> lock(mutex);
+    mapped.close();
+    if (appendFile) {
+        std::fclose(appendFile);
+    }
+}
+
+/**
+ * @brief Looks up a cached response.
+ *
+ * @param key The cache key, see searchKey() and detailsKey().
+ * @param counted Count the lookup in the hit and miss statistics; false for a repeated lookup.
+ * @return The cached body, or std::nullopt if it is missing or expired.
+ */
+std::optional<std::string> ResponseCache::get(const std::string &key, bool counted) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        if (counted) counters.misses++;
+        return std::nullopt;
+    }
+    if (isExpired(it->second, unixNow())) {
+        erase(it);
+        if (counted) counters.misses++;
+        return std::nullopt;
+    }
+
+    const Entry &entry = it->second;
+    // Remap if the value was appended after the file was last mapped
+    if (entry.offset + entry.size > mapped.size() && !mapped.open(path)) {
+        if (counted) counters.misses++;
+        return std::nullopt;
+    }
+    if (entry.offset + entry.size > mapped.size()) {
+        std::cerr << "ERROR: Response cache entry lies past the end of " << path << std::endl;
+        erase(it);
+        if (counted) counters.misses++;
+        return std::nullopt;
+    }
+
+    lru.splice(lru.begin(), lru, entry.lru);// Mark as most recently used
+    if (counted) counters.hits++;
+    return std::string(mapped.data() + entry.offset, entry.size);
+}
+
+/**
+ * @brief Stores a response, replacing any previous value for the key.
+ *
+ * @param key The cache key, see searchKey() and detailsKey().
+ * @param value The response body.
+ */
+void ResponseCache::put(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!appendFile || sizeof(RecordHeader) + key.size() + value.size() > maxBytes) {
+        return;
+    }
+
+    RecordHeader header{static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size()), unixNow()};
+    bool written = std::fwrite(&header, sizeof(header), 1, appendFile) == 1 &&
+                   std::fwrite(key.data(), 1, key.size(), appendFile) == key.size() &&
+                   std::fwrite(value.data(), 1, value.size(), appendFile) == value.size() &&
+                   std::fflush(appendFile) == 0;
+    if (!written) {
+        std::cerr << "ERROR: Failed to write to response cache " << path << std::endl;
+        // Drop the torn record and everything after it on the next start
+        std::fclose(appendFile);
+        appendFile = nullptr;
+        return;
+    }
+
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        erase(existing);
+    }
+
+    lru.push_front(key);
+    Entry entry{fileSize + sizeof(header) + key.size(), header.valueSize, header.storedAt, lru.begin()};
+    fileSize += sizeof(header) + key.size() + value.size();
+    liveBytes += recordSize(key, entry);
+    index.emplace(key, entry);
+    counters.stores++;
+
+    // Enforce the size cap by dropping the least recently used entries
+    while (liveBytes > maxBytes && lru.size() > 1) {
+        erase(index.find(lru.back()));
+        counters.evictions++;
+    }
+
+    // Rewrite the file once most of it is dead records
+    size_t deadBytes = fileSize - sizeof(kMagic) - liveBytes;
+    if (deadBytes > maxBytes / 2 && deadBytes > liveBytes) {
+        compact();
+    }
+}
+
+/**
+ * @brief Returns the hit/miss counters and the current cache size.
+ */
+ResponseCache::Stats ResponseCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = counters;
+    result.entries = index.size();
+    result.liveBytes = liveBytes;
+    result.fileBytes = fileSize;
+    return result;
+}
+
+/**
+ * @brief Builds the cache key of a title search.
+ *
+ * The query is lower-cased and its whitespace trimmed and collapsed, so
+ * "Star Wars" and " star  wars" share one entry. Pages after the first get
+ * their own entry.
+ *
+ * @param query The search query string.
+ * @param page The 1-based result page.
+ * @return The cache key.
+ */
+std::string ResponseCache::searchKey(const std::string &query, int page) {
+    std::string key = "s:";
+    bool pendingSpace = false;
+    for (unsigned char c: query) {
+        if (std::isspace(c)) {
+            pendingSpace = key.size() > 2;
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += static_cast<char>(std::tolower(c));
+    }
+    if (page > 1) {
+        key += "#p" + std::to_string(page);
+    }
+    return key;
+}
+
+/**
+ * @brief Builds the cache key of a details lookup.
+ *
+ * @param imdbID The IMDb ID of the movie.
+ * @return The cache key.
+ */
+std::string ResponseCache::detailsKey(const std::string &imdbID) {
+    return "i:" + imdbID;
+}
+
+// Map the file and rebuild the index from its records, starting a fresh file if it is missing or invalid
+void ResponseCache::load() {
+    if (fs::exists(path) && mapped.open(path) && mapped.size() >= sizeof(kMagic) &&
+        std::memcmp(mapped.data(), kMagic, sizeof(kMagic)) == 0) {
+        int64_t now = unixNow();
+        size_t offset = sizeof(kMagic);
+        while (offset + sizeof(RecordHeader) <= mapped.size()) {
+            RecordHeader header;
+            std::memcpy(&header, mapped.data() + offset, sizeof(header));
+            size_t end = offset + sizeof(header) + header.keySize + header.valueSize;
+            if (end > mapped.size()) {
+                break;// Torn record from an interrupted write
+            }
+
+            std::string key(mapped.data() + offset + sizeof(header), header.keySize);
+            auto existing = index.find(key);
+            if (existing != index.end()) {
+                erase(existing);
+            }
+            // Later records are more recent, so they go to the front of the LRU list
+            Entry entry{offset + sizeof(header) + header.keySize, header.valueSize, header.storedAt, {}};
+            if (!isExpired(entry, now)) {
+                lru.push_front(key);
+                entry.lru = lru.begin();
+                liveBytes += recordSize(key, entry);
+                index.emplace(std::move(key), entry);
+            }
+            offset = end;
+        }
+        fileSize = offset;
+
+        if (offset < mapped.size()) {
+            mapped.close();
+            std::error_code ec;
+            fs::resize_file(path, offset, ec);
+        }
+    } else {
+        mapped.close();
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "ERROR: Could not create response cache " << path << std::endl;
+            return;
+        }
+        std::fwrite(kMagic, 1, sizeof(kMagic), file);
+        std::fclose(file);
+        fileSize = sizeof(kMagic);
+    }
+
+    openForAppend();
+    if (liveBytes > maxBytes || fileSize - sizeof(kMagic) - liveBytes > maxBytes / 2) {
+        while (liveBytes > maxBytes && lru.size() > 1) {
+            erase(index.find(lru.back()));
+        }
+        compact();
+    }
+}
+
+void ResponseCache::openForAppend() {
+    appendFile = std::fopen(path.c_str(), "ab");
+    if (!appendFile) {
+        std::cerr << "ERROR: Could not open response cache for writing: " << path << std::endl;
+    }
+}
+
+// Remove an entry from the index; its record stays in the file as dead bytes
+void ResponseCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+    liveBytes -= recordSize(it->first, it->second);
+    lru.erase(it->second.lru);
+    index.erase(it);
+}
+
+// Rewrite the file with only the live records, oldest first, and swap it in atomically
+void ResponseCache::compact() {
+    if (!mapped.open(path)) {
+        return;
+    }
+
+    std::string tempPath = path + ".tmp";
+    std::FILE *out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "ERROR: Could not compact response cache " << path << std::endl;
+        return;
+    }
+
+    std::vector<std::pair<const std::string *, Entry *>> live;
+    live.reserve(index.size());
+    for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+        Entry &entry = index.at(*it);
+        live.emplace_back(&*it, &entry);
+    }
+
+    bool ok = std::fwrite(kMagic, 1, sizeof(kMagic), out) == sizeof(kMagic);
+    uint64_t offset = sizeof(kMagic);
+    std::vector<uint64_t> newOffsets;
+    newOffsets.reserve(live.size());
+    for (const auto &[key, entry]: live) {
+        if (!ok || entry->offset + entry->size > mapped.size()) {
+            ok = false;
+            break;
+        }
+        RecordHeader header{static_cast<uint32_t>(key->size()), entry->size, entry->storedAt};
+        ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+             std::fwrite(key->data(), 1, key->size(), out) == key->size() &&
+             std::fwrite(mapped.data() + entry->offset, 1, entry->size, out) == entry->size;
+        newOffsets.push_back(offset + sizeof(header) + key->size());
+        offset += sizeof(header) + key->size() + entry->size;
+    }
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok) {
+        std::cerr << "ERROR: Failed to compact response cache " << path << std::endl;
+        std::error_code ec;
+        fs::remove(tempPath, ec);
+        return;
+    }
+
+    // The old file can only be replaced once nothing maps or holds it
+    mapped.close();
+    if (appendFile) {
+        std::fclose(appendFile);
+        appendFile = nullptr;
+    }
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not replace response cache " << path << ": " << ec.message() << std::endl;
+        fs::remove(tempPath, ec);
+        openForAppend();
+        return;
+    }
+
+    for (size_t i = 0; i < live.size(); i++) {
+        live[i].second->offset = newOffsets[i];
+    }
+    fileSize = offset;
+    openForAppend();
+}
+
+bool ResponseCache::isExpired(const Entry &entry, int64_t now) const {
+    return now - entry.storedAt > ttl.count();
+}
+
+size_t ResponseCache::recordSize(const std::string &key, const Entry &entry) {
+    return sizeof(RecordHeader) + key.size() + entry.size;
+}
@@ -0,0 +1,82 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include "MappedFile.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+
+/**
+ * @class ResponseCache
+ * @brief A persistent key/value cache for OMDb response bodies.
+ *
+ * All entries live in a single append-only file: a magic header followed by
+ * records of [key size, value size, store time, key, value]. An in-memory
+ * index maps each key to its value's offset, and lookups copy the value
+ * straight out of a memory mapping of the file. Entries expire after the TTL;
+ * when the live data exceeds the size cap the least recently used entries are
+ * dropped, and the file is compacted once dead records dominate it.
+ */
+class ResponseCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;     // Lookups served from the cache
+        uint64_t misses = 0;   // Lookups that had to go to the network
+        uint64_t stores = 0;   // Responses written to the cache
+        uint64_t evictions = 0;// Entries dropped by the size cap
+        size_t entries = 0;    // Entries currently cached
+        size_t liveBytes = 0;  // Bytes used by the cached entries
+        size_t fileBytes = 0;  // Size of the cache file, including dead records
+    };
+
+    explicit ResponseCache(const std::string &path,
+                           std::chrono::seconds ttl = std::chrono::hours(24),
+                           size_t maxBytes = 32 * 1024 * 1024);
+    ~ResponseCache();
+
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+    std::optional<std::string> get(const std::string &key, bool counted = true);
+    void put(const std::string &key, const std::string &value);
+    Stats stats() const;
+
+    static std::string searchKey(const std::string &query, int page = 1);
+    static std::string detailsKey(const std::string &imdbID);
+
+private:
+    struct Entry {
+        uint64_t offset;  // Offset of the value in the file
+        uint32_t size;    // Size of the value
+        int64_t storedAt; // Unix time the value was stored
+        std::list<std::string>::iterator lru;
+    };
+
+    void load();
+    void openForAppend();
+    void erase(std::unordered_map<std::string, Entry>::iterator it);
+    void compact();
+    bool isExpired(const Entry &entry, int64_t now) const;
+    static size_t recordSize(const std::string &key, const Entry &entry);
+
+    std::string path;
+    std::chrono::seconds ttl;
+    size_t maxBytes;
+
+    std::unordered_map<std::string, Entry> index;
+    std::list<std::string> lru;// Most recently used keys first
+    MappedFile mapped;
+    std::FILE *appendFile = nullptr;
+    uint64_t fileSize = 0;
+    size_t liveBytes = 0;// Bytes of records still referenced by the index
+    Stats counters;
+    mutable std::mutex mutex;
+};
+
+#endif // RESPONSE_CACHE_H
@@ -0,0 +1,168 @@
+#include "ResultFeed.h"
+
+
+/**
+ * @brief Starts a new search; the GUI list is cleared on the next drain.
+ *
+ * Results still arriving for earlier searches are dropped from now on.
+ *
+ * @return The generation ID to publish the new search's results with.
+ */
+uint64_t ResultFeed::beginSearch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation++;
+    active = true;
+    total = 0;
+    visible = 0;
+    resetPending = true;
+    pendingMovies.clear();
+    pendingPosters.clear();
+    return generation;
+}
+
+// Wake the GUI thread so it draws the change; called without the mutex held
+void ResultFeed::notify() {
+    if (wake) {
+        wake();
+    }
+}
+
+/**
+ * @brief Shows or hides the searching indicator while a page is being fetched.
+ *
+ * @param generation The generation ID returned by beginSearch().
+ * @param searching true while the user is waiting for results.
+ */
+void ResultFeed::setSearching(uint64_t generation, bool searching) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation != this->generation) {
+            return;
+        }
+        active = searching;
+    }
+    notify();
+}
+
+/**
+ * @brief Records how many matches the search has across all pages.
+ *
+ * @param generation The generation ID returned by beginSearch().
+ * @param totalResults The total reported by OMDb.
+ */
+void ResultFeed::setTotalResults(uint64_t generation, int totalResults) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation != this->generation) {
+            return;
+        }
+        total = totalResults;
+    }
+    notify();
+}
+
+/**
+ * @brief Publishes a movie whose details have arrived.
+ *
+ * Safe to call from any thread.
+ *
+ * @param generation The generation ID of the search the movie belongs to.
+ * @param movie The movie to append to the results table.
+ */
+void ResultFeed::publishMovie(uint64_t generation, const Movie &movie) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation != this->generation) {
+            return;// Result of an abandoned search
+        }
+        pendingMovies.push_back(movie);
+    }
+    notify();
+}
+
+/**
+ * @brief Announces that the poster of a movie has been saved to disk.
+ *
+ * Safe to call from any thread.
+ *
+ * @param generation The generation ID of the search the poster belongs to.
+ * @param imdbID The IMDb ID of the movie whose poster is ready.
+ * @param posterPath The local path of the poster file.
+ */
+void ResultFeed::publishPoster(uint64_t generation, const std::string &imdbID, const std::string &posterPath) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation != this->generation) {
+            return;// Result of an abandoned search
+        }
+        pendingPosters.emplace_back(imdbID, posterPath);
+    }
+    notify();
+}
+
+/**
+ * @brief Returns true while the newest search is still fetching results.
+ */
+bool ResultFeed::searching() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active;
+}
+
+/**
+ * @brief Returns the number of matches of the newest search, 0 until its first page arrives.
+ */
+int ResultFeed::totalResults() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total;
+}
+
+/**
+ * @brief Moves everything published since the last call into the GUI's movie list.
+ *
+ * Must be called with the movies mutex held. A movie's poster path is filled
+ * in once its poster is on disk, whether the poster arrived before or after
+ * the movie itself.
+ *
+ * @param movies The movie list rendered by the GUI.
+ * @param reset Set to true if the list was cleared for a new search, may be nullptr.
+ * @return true if the list changed.
+ */
+bool ResultFeed::drain(std::vector<Movie> &movies, bool *reset) {
+    std::vector<Movie> newMovies;
+    std::vector<std::pair<std::string, std::string>> newPosters;
+    bool cleared;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cleared = resetPending;
+        resetPending = false;
+        newMovies.swap(pendingMovies);
+        newPosters.swap(pendingPosters);
+    }
+
+    if (cleared) {
+        movies.clear();
+        readyPosters.clear();
+    }
+    if (reset) {
+        *reset = cleared;
+    }
+
+    for (const auto &[imdbID, posterPath]: newPosters) {
+        readyPosters[imdbID] = posterPath;
+        for (auto &movie: movies) {
+            if (movie.imdbID == imdbID) {
+                movie.posterPath = posterPath;// Load the poster on the next render
+            }
+        }
+    }
+
+    for (auto &movie: newMovies) {
+        auto poster = readyPosters.find(movie.imdbID);
+        if (poster != readyPosters.end()) {
+            movie.posterPath = poster->second;
+        }
+        movies.push_back(std::move(movie));
+    }
+
+    return cleared || !newMovies.empty() || !newPosters.empty();
+}
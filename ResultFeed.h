@@ -0,0 +1,66 @@
+#ifndef RESULT_FEED_H
+#define RESULT_FEED_H
+
+#include "Movie.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @class ResultFeed
+ * @brief Hands search results from the fetch threads to the GUI thread one movie at a time.
+ *
+ * Fetch threads publish each Movie as soon as its details arrive and announce
+ * posters once they are saved to disk. The GUI drains the feed every frame,
+ * so rows appear as they complete and posters fill in later.
+ *
+ * Every search gets a generation ID from beginSearch(). Results published
+ * with an older generation are dropped, so a slow response to an abandoned
+ * query never ends up in the newer query's list.
+ *
+ * The GUI reports how many rows the user has scrolled through with
+ * setVisibleRows(), counted in the order the rows were received, whatever
+ * the table's filter and sort. This tells the search when to fetch the next
+ * page.
+ * Every change calls the wake callback, so an idle GUI thread waiting for
+ * events redraws as soon as results arrive.
+ */
+class ResultFeed {
+public:
+    void setWakeCallback(std::function<void()> callback) { wake = std::move(callback); }
+
+    uint64_t beginSearch();
+    void setSearching(uint64_t generation, bool searching);
+    void setTotalResults(uint64_t generation, int totalResults);
+    void publishMovie(uint64_t generation, const Movie &movie);
+    void publishPoster(uint64_t generation, const std::string &imdbID, const std::string &posterPath);
+
+    bool drain(std::vector<Movie> &movies, bool *reset = nullptr);
+    bool searching() const;
+    int totalResults() const;
+
+    void setVisibleRows(size_t rows) { visible = rows; }
+    size_t visibleRows() const { return visible; }
+
+private:
+    void notify();
+
+    mutable std::mutex mutex;
+    uint64_t generation = 0;                // ID of the newest search
+    bool active = false;                    // The newest search is fetching a page the user is waiting for
+    int total = 0;                          // Matches of the newest search across all pages
+    std::atomic<size_t> visible{0};         // Rows the user has scrolled through
+    std::function<void()> wake;             // Wakes the GUI thread, set before the first search
+    bool resetPending = false;              // Clear the GUI list on the next drain
+    std::vector<Movie> pendingMovies;       // Movies not yet handed to the GUI
+    std::vector<std::pair<std::string, std::string>> pendingPosters;// IMDb ID and path of posters saved since the last drain
+    std::unordered_map<std::string, std::string> readyPosters;      // Posters already on disk for the current search
+};
+
+#endif // RESULT_FEED_H
@@ -0,0 +1,160 @@
+#ifndef SINGLE_FLIGHT_H
+#define SINGLE_FLIGHT_H
+
+#include "CancellationToken.h"
+#include "TaskScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+
+/**
+ * @class SingleFlight
+ * @brief Lets concurrent callers asking for the same key share one outstanding request.
+ *
+ * The first caller for a key (the leader) starts the request; callers
+ * arriving while it is in flight wait for the leader's result instead of
+ * issuing the same request again. Nothing is cached: once the result is
+ * delivered the next caller issues a new request.
+ *
+ * With an executor, requests run there and the leader waits like everybody
+ * else; otherwise the leader runs the request itself. Waiting callers run
+ * queued scheduler tasks meanwhile (TaskScheduler::wait()), so requests that
+ * block, e.g. on a rate limit, and their duplicates do not tie up the
+ * scheduler's workers. Every caller
+ * keeps its own cancellation. A waiting caller whose token is cancelled
+ * returns T{} right away; if the leader's token is cancelled before the
+ * request has an answer, the callers that still want the result retry, and
+ * one of them becomes the new leader.
+ *
+ * @tparam T The result type; T{} must stand for "no result", e.g. std::nullopt or an empty string.
+ */
+template<typename T>
+class SingleFlight {
+public:
+    struct Stats {
+        uint64_t issued = 0;   // Requests actually run
+        uint64_t coalesced = 0;// Calls answered by a request already in flight
+    };
+
+    explicit SingleFlight(TaskScheduler &scheduler, TaskScheduler *executor = nullptr)
+        : scheduler(scheduler), executor(executor) {}
+
+    template<typename F>
+    T run(const std::string &key, const CancellationToken &token, F &&request,
+          TaskPriority priority = TaskPriority::Current);
+
+    Stats stats() const { return {issued.load(std::memory_order_relaxed), coalesced.load(std::memory_order_relaxed)}; }
+
+private:
+    struct Outcome {
+        T value{};
+        bool abandoned = false;// The leader was cancelled without an answer, value is not a real one
+    };
+
+    template<typename F>
+    void complete(const std::string &key, const CancellationToken &token, F &request, std::promise<Outcome> &promise);
+
+    TaskScheduler &scheduler;// Runs queued tasks while a caller waits for the request
+    TaskScheduler *executor; // Runs the requests, or nullptr to run them on the leader's thread
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_future<Outcome>> inFlight;
+    std::atomic<uint64_t> issued{0};
+    std::atomic<uint64_t> coalesced{0};
+};
+
+/**
+ * @brief Runs the request for a key, or waits for the identical request already in flight.
+ *
+ * @param key Identifies the request, e.g. its URL or the IMDb ID it fetches.
+ * @param token Cancels this caller; a cancelled leader abandons the request for everybody.
+ * @param request Callable with no arguments returning T; only called for the leader. With an
+ *        executor it is copied and may outlive the call, so it must not refer to the caller's locals.
+ * @param priority Scheduling class of the request on the executor.
+ * @return The request's result, or T{} if this caller was cancelled.
+ */
+template<typename T>
+template<typename F>
+T SingleFlight<T>::run(const std::string &key, const CancellationToken &token, F &&request, TaskPriority priority) {
+    while (!token.cancelled()) {
+        std::promise<Outcome> promise;
+        std::shared_future<Outcome> shared;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto [entry, added] = inFlight.try_emplace(key);
+            if (added) {
+                entry->second = promise.get_future().share();
+                leader = true;
+            }
+            shared = entry->second;
+        }
+
+        if (leader) {
+            issued.fetch_add(1, std::memory_order_relaxed);
+            if (executor) {
+                executor->submit(priority, [this, key, token, request, promise = std::move(promise)]() mutable {
+                    complete(key, token, request, promise);
+                });
+            } else {
+                complete(key, token, request, promise);
+            }
+        }
+
+        // Help with other tasks meanwhile; a cancelled caller does not sit out the whole request
+        if (!scheduler.wait(shared, token)) {
+            return T{};
+        }
+        try {
+            const Outcome &outcome = shared.get();
+            if (!outcome.abandoned) {
+                if (!leader) {
+                    coalesced.fetch_add(1, std::memory_order_relaxed);// Once per call, however many leaders it outlived
+                }
+                return outcome.value;
+            }
+        } catch (const std::future_error &) {
+            // The executor shut down before running the request. Completed requests remove
+            // their entry before publishing, so an entry that is already ready is this stale one.
+            std::lock_guard<std::mutex> lock(mutex);
+            auto entry = inFlight.find(key);
+            if (entry != inFlight.end() && entry->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                inFlight.erase(entry);
+            }
+            return T{};
+        }
+    }
+    return T{};
+}
+
+// Run the request and publish its outcome, or its exception, to every caller waiting for the key
+template<typename T>
+template<typename F>
+void SingleFlight<T>::complete(const std::string &key, const CancellationToken &token, F &request, std::promise<Outcome> &promise) {
+    Outcome outcome;
+    try {
+        outcome.value = request();
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inFlight.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        return;
+    }
+    // A cancelled request returns T{}; an answer that arrived before the cancellation is still shared
+    outcome.abandoned = token.cancelled() && outcome.value == T{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight.erase(key);
+    }
+    promise.set_value(outcome);
+}
+
+#endif // SINGLE_FLIGHT_H
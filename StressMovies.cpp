@@ -0,0 +1,33 @@
+#include "StressMovies.h"
+#include <cstdio>
+#include <string>
+
+
+/**
+ * @brief Builds synthetic movies for the results table stress test.
+ *
+ * The movies have no posters, so the test measures the table itself.
+ *
+ * @param count Number of movies to build.
+ * @return The movies.
+ */
+std::vector<Movie> MakeStressMovies(size_t count) {
+    static const char *genres[] = {"Action, Adventure", "Comedy", "Drama, Romance", "Horror, Thriller", "Animation, Family"};
+    std::vector<Movie> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Movie movie;
+        char text[32];
+        movie.title = "Stress Movie " + std::to_string(i);
+        movie.releaseYear = 1950 + static_cast<int>(i % 75);
+        movie.year = std::to_string(movie.releaseYear);
+        movie.genre = genres[i % (sizeof(genres) / sizeof(genres[0]))];
+        movie.rating = static_cast<float>((i * 37) % 91) / 10.0f;
+        std::snprintf(text, sizeof(text), "%.1f", movie.rating);
+        movie.imdbRating = text;
+        std::snprintf(text, sizeof(text), "tt%07zu", i + 1);
+        movie.imdbID = text;
+        result.push_back(std::move(movie));
+    }
+    return result;
+}
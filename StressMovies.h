@@ -0,0 +1,11 @@
+#ifndef STRESS_MOVIES_H
+#define STRESS_MOVIES_H
+
+#include "Movie.h"
+#include <cstddef>
+#include <vector>
+
+// Synthetic movies without posters for the results table stress test and the sort benchmark
+std::vector<Movie> MakeStressMovies(size_t count);
+
+#endif // STRESS_MOVIES_H
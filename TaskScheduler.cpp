@@ -0,0 +1,140 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+namespace {
+    // Scheduler and worker index of the calling thread, if it is a worker
+    thread_local const TaskScheduler *currentScheduler = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param workerCount Number of tasks running at the same time. Most tasks
+ *        wait on the network, so this is usually larger than the core count.
+ */
+TaskScheduler::TaskScheduler(size_t workerCount) {
+    workerCount = std::max<size_t>(1, workerCount);
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workerCount; i++) {
+        threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Stops the scheduler, see shutdown().
+ */
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+/**
+ * @brief Drops the queued tasks and joins the workers.
+ *
+ * Tasks that are already running finish first, so callers should cancel
+ * long-running work before shutting down. Dropped tasks report
+ * std::future_errc::broken_promise, which also releases any task waiting
+ * for them. Safe to call more than once.
+ */
+void TaskScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto &worker: workers) {
+        std::array<std::deque<std::function<void()>>, kPriorityCount> dropped;
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            dropped.swap(worker->lanes);
+        }
+        for (auto &lane: dropped) {
+            queued -= lane.size();
+        }
+    }// Destroying the tasks outside the lock breaks their promises
+
+    for (auto &thread: threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+// Queue a task on the calling worker, or round-robin when called from outside the pool
+void TaskScheduler::push(TaskPriority priority, std::function<void()> task) {
+    size_t index = currentScheduler == this ? currentIndex : nextWorker++ % workers.size();
+    queued++;// Counted first so takeTask never drives the count below zero
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        if (stopping) {
+            queued--;
+            return;// Dropping the task breaks its promise
+        }
+        workers[index]->lanes[static_cast<size_t>(priority)].push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);// Pairs with the predicate check in workerLoop
+    }
+    taskAvailable.notify_one();
+}
+
+// Take the highest-priority task: own queue first, then steal from the others
+bool TaskScheduler::takeTask(std::function<void()> &task) {
+    if (queued == 0) {
+        return false;
+    }
+    size_t self = currentWorker();
+    for (size_t level = 0; level < kPriorityCount; level++) {
+        for (size_t offset = 0; offset < workers.size(); offset++) {
+            Worker &worker = *workers[(self + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto &lane = worker.lanes[level];
+            if (lane.empty()) {
+                continue;
+            }
+            // The owner keeps FIFO order, thieves take the newest task to stay out of its way
+            if (offset == 0) {
+                task = std::move(lane.front());
+                lane.pop_front();
+            } else {
+                task = std::move(lane.back());
+                lane.pop_back();
+            }
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Run one queued task on the calling thread, if there is any
+bool TaskScheduler::runOne() {
+    std::function<void()> task;
+    if (!takeTask(task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+// Index of the calling worker, 0 for threads outside the pool
+size_t TaskScheduler::currentWorker() const {
+    return currentScheduler == this ? currentIndex : 0;
+}
+
+// Worker thread: run tasks until the scheduler stops, sleeping while there are none
+void TaskScheduler::workerLoop(size_t index) {
+    currentScheduler = this;
+    currentIndex = index;
+    while (!stopping) {
+        if (runOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        taskAvailable.wait(lock, [this]() { return stopping || queued > 0; });
+    }
+}
@@ -0,0 +1,140 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include "CancellationToken.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+/**
+ * @brief Scheduling class of a task; lower values run first.
+ */
+enum class TaskPriority {
+    Visible = 0,   // Work for rows currently on screen, e.g. poster decodes
+    Current = 1,   // Searches, detail fetches and poster downloads of the newest query
+    Background = 2,// Work nobody is waiting for yet, e.g. prefetching
+};
+
+
+/**
+ * @class TaskScheduler
+ * @brief A long-lived, work-stealing pool running every background task of the application.
+ *
+ * Each worker owns one queue per priority. Tasks submitted from a worker go
+ * to that worker's own queue, tasks submitted from other threads are spread
+ * round-robin. An idle worker takes the highest-priority task it can find,
+ * looking at its own queue first and stealing from the other workers
+ * otherwise, so a visible poster decode never waits behind downloads that
+ * were queued earlier.
+ *
+ * A task that waits for other tasks must use wait(), which runs queued tasks
+ * in the meantime; blocking a worker on a plain future could otherwise use
+ * up every worker and deadlock the pool.
+ */
+class TaskScheduler {
+public:
+    explicit TaskScheduler(size_t workerCount = 8);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    template<typename F>
+    auto submit(TaskPriority priority, F &&task) -> std::future<std::invoke_result_t<F>>;
+
+    template<typename Future>
+    void wait(Future &future);
+    template<typename Future>
+    bool wait(Future &future, const CancellationToken &token);
+
+    void shutdown();
+
+    size_t workerCount() const { return threads.size(); }
+
+private:
+    static constexpr size_t kPriorityCount = 3;
+
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<std::function<void()>>, kPriorityCount> lanes;// One FIFO queue per priority
+    };
+
+    void push(TaskPriority priority, std::function<void()> task);
+    bool takeTask(std::function<void()> &task);
+    bool runOne();
+    size_t currentWorker() const;
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};     // Tasks waiting in any queue
+    std::atomic<size_t> nextWorker{0}; // Round-robin target for tasks submitted from outside the pool
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable taskAvailable;
+};
+
+/**
+ * @brief Queues a task on the scheduler.
+ *
+ * Tasks submitted after shutdown() are dropped; their future reports
+ * std::future_errc::broken_promise.
+ *
+ * @param priority Scheduling class of the task.
+ * @param task Callable with no arguments.
+ * @return A future holding the task's result (or the exception it threw).
+ */
+template<typename F>
+auto TaskScheduler::submit(TaskPriority priority, F &&task) -> std::future<std::invoke_result_t<F>> {
+    using Result = std::invoke_result_t<F>;
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    std::future<Result> future = packaged->get_future();
+    push(priority, [packaged]() { (*packaged)(); });
+    return future;
+}
+
+/**
+ * @brief Waits for a future, running queued tasks while it is not ready.
+ *
+ * @param future The future (or shared future) to wait for; it is ready when this returns.
+ */
+template<typename Future>
+void TaskScheduler::wait(Future &future) {
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (!runOne()) {
+            future.wait_for(std::chrono::milliseconds(1));// Nothing to help with, the task is running elsewhere
+        }
+    }
+}
+
+/**
+ * @brief Waits for a future like wait(), but gives up once the token is cancelled.
+ *
+ * @param future The future (or shared future) to wait for.
+ * @param token Ends the wait when cancelled; checked between tasks run meanwhile.
+ * @return true if the future is ready, false if the token was cancelled first.
+ */
+template<typename Future>
+bool TaskScheduler::wait(Future &future, const CancellationToken &token) {
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (token.cancelled()) {
+            return false;
+        }
+        if (!runOne()) {
+            future.wait_for(std::chrono::milliseconds(1));
+        }
+    }
+    return true;
+}
+
+#endif // TASK_SCHEDULER_H
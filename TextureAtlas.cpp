@@ -0,0 +1,172 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <iostream>
+
+// imgui_draw.cpp compiles its own static copy, so keep this one static too
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+namespace {
+    const int kPadding = 2;// Gap between slots so linear filtering never samples a neighbour
+}
+
+
+/**
+ * @brief Creates an empty atlas; pages are allocated on demand.
+ *
+ * @param thumbnailWidth Width of every thumbnail in pixels.
+ * @param thumbnailHeight Height of every thumbnail in pixels.
+ * @param pageSize Width and height of an atlas page in pixels.
+ * @param maxBytes GPU memory budget for all pages together.
+ */
+TextureAtlas::TextureAtlas(int thumbnailWidth, int thumbnailHeight, int pageSize, size_t maxBytes)
+    : slotWidth(thumbnailWidth), slotHeight(thumbnailHeight), pageSize(pageSize) {
+    size_t pageBytes = static_cast<size_t>(pageSize) * pageSize * 4;
+    maxPages = std::max<size_t>(1, maxBytes / pageBytes);
+}
+
+/**
+ * @brief Deletes the atlas pages; the GL context must still be current.
+ */
+TextureAtlas::~TextureAtlas() {
+    clear();
+}
+
+/**
+ * @brief Starts a new frame; slots drawn from now on are protected from eviction.
+ */
+void TextureAtlas::beginFrame() {
+    frame++;
+}
+
+/**
+ * @brief Looks up the thumbnail of a movie and marks it as drawn this frame.
+ *
+ * @param imdbID The IMDb ID of the movie.
+ * @return The region to pass to ImGui::Image, or std::nullopt if it is not resident.
+ */
+std::optional<TextureAtlas::Region> TextureAtlas::find(const std::string &imdbID) {
+    auto it = slotsByID.find(imdbID);
+    if (it == slotsByID.end()) {
+        return std::nullopt;
+    }
+    Slot &slot = slots[it->second];
+    slot.lastUsed = frame;
+    return slot.region;
+}
+
+/**
+ * @brief Uploads a thumbnail into a free slot, evicting the least recently drawn one if needed.
+ *
+ * @param imdbID The IMDb ID of the movie.
+ * @param thumbnail RGBA8 image of exactly thumbnailWidth() x thumbnailHeight() pixels.
+ * @return true if the thumbnail is resident, false if every slot is in use this frame.
+ */
+bool TextureAtlas::insert(const std::string &imdbID, const DecodedImage &thumbnail) {
+    if (thumbnail.width != slotWidth || thumbnail.height != slotHeight) {
+        std::cerr << "ERROR: Thumbnail for " << imdbID << " has the wrong size" << std::endl;
+        return false;
+    }
+
+    Slot *slot = nullptr;
+    auto existing = slotsByID.find(imdbID);
+    if (existing != slotsByID.end()) {
+        slot = &slots[existing->second];
+    } else {
+        slot = allocateSlot();
+        if (!slot) {
+            return false;
+        }
+        slot->imdbID = imdbID;
+        slotsByID[imdbID] = static_cast<size_t>(slot - slots.data());
+    }
+
+    glBindTexture(GL_TEXTURE_2D, pages[slot->page]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, slot->x, slot->y, slotWidth, slotHeight, GL_RGBA, GL_UNSIGNED_BYTE, thumbnail.pixels.data());
+    slot->lastUsed = frame;
+    return true;
+}
+
+/**
+ * @brief Deletes every page and forgets all thumbnails.
+ */
+void TextureAtlas::clear() {
+    if (!pages.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(pages.size()), pages.data());
+    }
+    pages.clear();
+    slots.clear();
+    freeSlots.clear();
+    slotsByID.clear();
+}
+
+// Create a page texture and carve it into thumbnail slots with stb_rect_pack
+bool TextureAtlas::addPage() {
+    if (pages.size() >= maxPages) {
+        return false;
+    }
+
+    int cellWidth = slotWidth + kPadding;
+    int cellHeight = slotHeight + kPadding;
+    int capacity = (pageSize / cellWidth) * (pageSize / cellHeight);
+    if (capacity == 0) {
+        return false;
+    }
+    std::vector<stbrp_rect> rects(capacity);
+    for (int i = 0; i < capacity; i++) {
+        rects[i].id = i;
+        rects[i].w = cellWidth;
+        rects[i].h = cellHeight;
+    }
+    std::vector<stbrp_node> nodes(pageSize);
+    stbrp_context context;
+    stbrp_init_target(&context, pageSize, pageSize, nodes.data(), static_cast<int>(nodes.size()));
+    stbrp_pack_rects(&context, rects.data(), capacity);
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pageSize, pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    size_t page = pages.size();
+    pages.push_back(texture);
+
+    float scale = 1.0f / pageSize;
+    for (const auto &rect: rects) {
+        if (!rect.was_packed) continue;
+        Slot slot;
+        slot.page = page;
+        slot.x = rect.x;
+        slot.y = rect.y;
+        slot.region.texture = (ImTextureID) (uintptr_t) texture;
+        slot.region.uv0 = ImVec2(slot.x * scale, slot.y * scale);
+        slot.region.uv1 = ImVec2((slot.x + slotWidth) * scale, (slot.y + slotHeight) * scale);
+        freeSlots.push_back(slots.size());
+        slots.push_back(slot);
+    }
+    return true;
+}
+
+// Take a free slot, add a page if the budget allows, or evict the least recently drawn slot
+TextureAtlas::Slot *TextureAtlas::allocateSlot() {
+    if (freeSlots.empty() && !addPage()) {
+        Slot *victim = nullptr;
+        for (auto &slot: slots) {
+            if (slot.lastUsed < frame && (!victim || slot.lastUsed < victim->lastUsed)) {
+                victim = &slot;
+            }
+        }
+        if (!victim) {
+            return nullptr;// Everything is on screen this frame
+        }
+        slotsByID.erase(victim->imdbID);
+        victim->imdbID.clear();
+        return victim;
+    }
+    size_t index = freeSlots.back();
+    freeSlots.pop_back();
+    return &slots[index];
+}
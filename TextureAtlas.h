@@ -0,0 +1,74 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include "ImageLoader.h"
+#include "imgui.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * @class TextureAtlas
+ * @brief GPU cache of poster thumbnails packed into shared atlas pages, keyed by IMDb ID.
+ *
+ * Every thumbnail has the same size, so each page is carved into slots once
+ * with stb_rect_pack and slots are reused as posters come and go. A poster
+ * shown again in a later search reuses its slot instead of uploading a new
+ * texture. When all pages allowed by the memory budget are full, the slot
+ * that was drawn least recently is reused; slots drawn in the current frame
+ * are never evicted. All methods must be called on the GL thread.
+ */
+class TextureAtlas {
+public:
+    struct Region {
+        ImTextureID texture;// Atlas page holding the thumbnail
+        ImVec2 uv0;         // Top-left texture coordinate
+        ImVec2 uv1;         // Bottom-right texture coordinate
+    };
+
+    TextureAtlas(int thumbnailWidth = 100, int thumbnailHeight = 150, int pageSize = 1024,
+                 size_t maxBytes = 32 * 1024 * 1024);
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    void beginFrame();
+    std::optional<Region> find(const std::string &imdbID);
+    bool contains(const std::string &imdbID) const { return slotsByID.count(imdbID) != 0; }
+    bool insert(const std::string &imdbID, const DecodedImage &thumbnail);
+    void clear();
+
+    int thumbnailWidth() const { return slotWidth; }
+    int thumbnailHeight() const { return slotHeight; }
+    size_t pageCount() const { return pages.size(); }
+    size_t residentCount() const { return slotsByID.size(); }
+
+private:
+    struct Slot {
+        size_t page;
+        int x, y;              // Top-left pixel of the thumbnail in the page
+        std::string imdbID;    // Empty when the slot is free
+        uint64_t lastUsed = 0; // Frame in which the slot was last drawn
+        Region region;
+    };
+
+    bool addPage();
+    Slot *allocateSlot();
+
+    int slotWidth;
+    int slotHeight;
+    int pageSize;
+    size_t maxPages;
+    uint64_t frame = 1;
+
+    std::vector<GLuint> pages;
+    std::vector<Slot> slots;
+    std::vector<size_t> freeSlots;
+    std::unordered_map<std::string, size_t> slotsByID;
+};
+
+#endif // TEXTURE_ATLAS_H
@@ -0,0 +1,125 @@
+#include "TextureLoader.h"
+#include "Thumbnail.h"
+
+
+/**
+ * @brief Constructs a loader that decodes posters on the task scheduler.
+ *
+ * @param scheduler Runs the decode tasks.
+ * @param thumbnailWidth Width posters are scaled to before upload.
+ * @param thumbnailHeight Height posters are scaled to before upload.
+ * @param uploadBudget Time per frame after which uploadPending() stops uploading.
+ */
+TextureLoader::TextureLoader(TaskScheduler &scheduler, int thumbnailWidth, int thumbnailHeight, std::chrono::microseconds uploadBudget)
+    : scheduler(scheduler), thumbnailWidth(thumbnailWidth), thumbnailHeight(thumbnailHeight),
+      output(std::make_shared<Output>()), uploadBudget(uploadBudget) {}
+
+/**
+ * @brief Skips the decodes that are still queued.
+ */
+TextureLoader::~TextureLoader() {
+    output->closed = true;
+}
+
+/**
+ * @brief Queues a poster for decoding unless it is already queued.
+ *
+ * Must be called on the GL thread. Posters of rows on screen are decoded
+ * ahead of downloads and other background work; rows just off screen can be
+ * requested at a lower priority so they are ready when scrolled into view.
+ * A poster that failed to decode is tried again when it arrives under a new
+ * path or after failedRetryDelay, e.g. once the poster cache has downloaded
+ * it again.
+ *
+ * @param imdbID The IMDb ID of the movie.
+ * @param path The path of the poster file.
+ * @param priority Scheduling class of the decode.
+ * @return true while the poster is loading, false if it could not be decoded.
+ */
+bool TextureLoader::request(const std::string &imdbID, const std::string &path, TaskPriority priority) {
+    auto failure = failed.find(imdbID);
+    if (failure != failed.end()) {
+        if (failure->second.path == path && std::chrono::steady_clock::now() - failure->second.time < failedRetryDelay) {
+            return false;
+        }
+        failed.erase(failure);
+    }
+    if (inFlight.insert(imdbID).second) {
+        scheduler.submit(priority, [out = output, imdbID, path, width = thumbnailWidth, height = thumbnailHeight]() {
+            if (out->closed) {
+                return;
+            }
+            Decoded result = decode(imdbID, path, width, height);
+            {
+                std::lock_guard<std::mutex> lock(out->mutex);
+                out->decoded.push_back(std::move(result));
+            }
+            if (out->wake) {
+                out->wake();
+            }
+        });
+    }
+    return true;
+}
+
+/**
+ * @brief Uploads decoded thumbnails into the atlas until the per-frame budget is spent.
+ *
+ * Must be called on the GL thread, once per frame. At least one thumbnail is
+ * uploaded per call so loading always makes progress.
+ *
+ * @param atlas The atlas receiving the thumbnails.
+ * @return The time spent uploading.
+ */
+std::chrono::steady_clock::duration TextureLoader::uploadPending(TextureAtlas &atlas) {
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        Decoded next;
+        {
+            std::lock_guard<std::mutex> lock(output->mutex);
+            if (output->decoded.empty()) {
+                break;
+            }
+            next = std::move(output->decoded.front());
+            output->decoded.pop_front();
+        }
+
+        inFlight.erase(next.imdbID);
+        if (!next.ok) {
+            failed[next.imdbID] = Failure{next.path, std::chrono::steady_clock::now()};
+        } else {
+            atlas.insert(next.imdbID, next.thumbnail);// Requested again if it does not fit this frame
+        }
+
+        if (std::chrono::steady_clock::now() - start >= uploadBudget) {
+            break;
+        }
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+/**
+ * @brief Returns true if decoded thumbnails are waiting for uploadPending().
+ */
+bool TextureLoader::hasPendingUploads() {
+    std::lock_guard<std::mutex> lock(output->mutex);
+    return !output->decoded.empty();
+}
+
+// Decode task: load or build the thumbnail of a poster
+TextureLoader::Decoded TextureLoader::decode(const std::string &imdbID, const std::string &path, int width, int height) {
+    Decoded result;
+    result.imdbID = imdbID;
+    result.path = path;
+    // The stored thumbnail skips JPEG decoding entirely
+    result.ok = LoadThumbnail(path, width, height, result.thumbnail);
+    if (!result.ok) {
+        DecodedImage image;
+        result.ok = DecodeImageFile(path, image);
+        if (result.ok) {
+            result.thumbnail = DownsampleBox(image, width, height);
+            SaveThumbnail(path, result.thumbnail);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include "ImageLoader.h"
+#include "TaskScheduler.h"
+#include "TextureAtlas.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+
+/**
+ * @class TextureLoader
+ * @brief Decodes poster images on background threads and uploads them to the atlas a few per frame.
+ *
+ * The GUI requests a poster when its row is drawn and the atlas does not
+ * have it. A scheduler task loads the stored thumbnail, or decodes the JPEG
+ * once, box-filters it down to thumbnail size and stores the thumbnail next
+ * to the poster for the next session; the pixels then wait until uploadPending() runs on the GL thread, which
+ * stops uploading once the per-frame budget is spent so no single frame
+ * absorbs all the poster work.
+ */
+class TextureLoader {
+public:
+    TextureLoader(TaskScheduler &scheduler, int thumbnailWidth, int thumbnailHeight,
+                  std::chrono::microseconds uploadBudget = std::chrono::milliseconds(2));
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader &) = delete;
+    TextureLoader &operator=(const TextureLoader &) = delete;
+
+    void setWakeCallback(std::function<void()> callback) { output->wake = std::move(callback); }
+
+    bool request(const std::string &imdbID, const std::string &path, TaskPriority priority = TaskPriority::Visible);
+    std::chrono::steady_clock::duration uploadPending(TextureAtlas &atlas);
+    bool hasPendingUploads();
+
+private:
+    struct Decoded {
+        std::string imdbID;
+        std::string path;
+        bool ok = false;
+        DecodedImage thumbnail;
+    };
+    // Shared with the decode tasks, which may still be queued when the loader goes away
+    struct Output {
+        std::deque<Decoded> decoded;// Thumbnails waiting for upload on the GL thread
+        std::mutex mutex;
+        std::atomic<bool> closed{false};// The loader is gone, queued decodes are skipped
+        std::function<void()> wake;     // Wakes the GL thread when a thumbnail is ready
+    };
+
+    // A poster that could not be decoded; retried once it is replaced or failedRetryDelay has passed
+    struct Failure {
+        std::string path;
+        std::chrono::steady_clock::time_point time;
+    };
+    static constexpr std::chrono::seconds failedRetryDelay{30};
+
+    static Decoded decode(const std::string &imdbID, const std::string &path, int width, int height);
+
+    TaskScheduler &scheduler;
+    int thumbnailWidth;
+    int thumbnailHeight;
+    std::shared_ptr<Output> output;
+
+    // Only touched on the GL thread
+    std::unordered_set<std::string> inFlight;// Posters queued or being decoded
+    std::unordered_map<std::string, Failure> failed;// Posters that could not be decoded, by IMDb ID
+    std::chrono::microseconds uploadBudget;
+};
+
+#endif // TEXTURE_LOADER_H
@@ -0,0 +1,240 @@
+#include "Thumbnail.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define THUMBNAIL_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char kMagic[4] = {'T', 'H', 'B', '1'};
+
+    // Header in front of the raw pixels; the source size and time detect a re-downloaded poster
+    struct ThumbnailHeader {
+        char magic[4];
+        uint16_t width;
+        uint16_t height;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+    };
+
+    // Size and modification time of the poster the thumbnail was made from
+    bool sourceStamp(const std::string &posterPath, uint64_t &size, int64_t &time) {
+        std::error_code ec;
+        size = fs::file_size(posterPath, ec);
+        if (ec) return false;
+        time = fs::last_write_time(posterPath, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    // Source pixels covering one destination pixel along an axis, with their area weights
+    struct Span {
+        int start;
+        int count;
+        size_t weights;// Offset into the weight array
+    };
+
+    // Box filter: every destination pixel averages the source area it covers, edges weighted by coverage
+    void buildSpans(int sourceLength, int length, std::vector<Span> &spans, std::vector<float> &weights) {
+        double scale = static_cast<double>(sourceLength) / length;
+        spans.resize(length);
+        for (int i = 0; i < length; i++) {
+            double begin = i * scale;
+            double end = std::min<double>((i + 1) * scale, sourceLength);
+            int first = std::min(static_cast<int>(begin), sourceLength - 1);
+            int last = std::max(first, std::min(static_cast<int>(std::ceil(end)) - 1, sourceLength - 1));
+            spans[i] = {first, last - first + 1, weights.size()};
+            float total = 0.0f;
+            for (int j = first; j <= last; j++) {
+                float w = static_cast<float>(std::min<double>(end, j + 1) - std::max<double>(begin, j));
+                w = std::max(w, 0.0f);
+                weights.push_back(w);
+                total += w;
+            }
+            if (total <= 0.0f) {
+                weights[spans[i].weights] = total = 1.0f;
+            }
+            for (int k = 0; k < spans[i].count; k++) {
+                weights[spans[i].weights + k] /= total;
+            }
+        }
+    }
+}// namespace
+
+
+/**
+ * @brief Returns the path of the thumbnail stored next to a poster.
+ *
+ * PosterCache deletes this file together with the poster.
+ *
+ * @param posterPath The path of the poster JPEG.
+ * @return The poster path with its extension replaced by ".thumb".
+ */
+std::string ThumbnailPathFor(const std::string &posterPath) {
+    return fs::path(posterPath).replace_extension(".thumb").string();
+}
+
+/**
+ * @brief Loads the stored thumbnail of a poster, skipping JPEG decoding entirely.
+ *
+ * @param posterPath The path of the poster JPEG.
+ * @param width Expected thumbnail width.
+ * @param height Expected thumbnail height.
+ * @param thumbnail Receives the RGBA8 pixels.
+ * @return false if there is no thumbnail, it has another size, or the poster changed since it was made.
+ */
+bool LoadThumbnail(const std::string &posterPath, int width, int height, DecodedImage &thumbnail) {
+    std::ifstream in(ThumbnailPathFor(posterPath), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    ThumbnailHeader header;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.width != width || header.height != height ||
+        !sourceStamp(posterPath, sourceSize, sourceTime) ||
+        header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+        return false;
+    }
+
+    thumbnail.width = width;
+    thumbnail.height = height;
+    thumbnail.pixels.resize(static_cast<size_t>(width) * height * 4);
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(thumbnail.pixels.data()), static_cast<std::streamsize>(thumbnail.pixels.size())));
+}
+
+/**
+ * @brief Stores the thumbnail of a poster, writing a temporary file and renaming it into place.
+ *
+ * @param posterPath The path of the poster JPEG the thumbnail was made from.
+ * @param thumbnail The RGBA8 thumbnail.
+ * @return true if the thumbnail was stored.
+ */
+bool SaveThumbnail(const std::string &posterPath, const DecodedImage &thumbnail) {
+    ThumbnailHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.width = static_cast<uint16_t>(thumbnail.width);
+    header.height = static_cast<uint16_t>(thumbnail.height);
+    if (!sourceStamp(posterPath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+
+    std::string path = ThumbnailPathFor(posterPath);
+    std::string tempPath = path + ".part";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char *>(&header), sizeof(header)) ||
+            !out.write(reinterpret_cast<const char *>(thumbnail.pixels.data()), static_cast<std::streamsize>(thumbnail.pixels.size()))) {
+            std::cerr << "ERROR: Could not write thumbnail " << tempPath << std::endl;
+            out.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Scales an image with an area-averaging box filter.
+ *
+ * The filter is separable: a horizontal pass into a float buffer, then a
+ * vertical pass back to bytes. Each RGBA pixel is processed as one 4-lane
+ * SSE2 vector where available.
+ *
+ * @param source The RGBA8 image to scale.
+ * @param width Width of the result in pixels.
+ * @param height Height of the result in pixels.
+ * @return The scaled RGBA8 image.
+ */
+DecodedImage DownsampleBox(const DecodedImage &source, int width, int height) {
+    DecodedImage result;
+    result.width = width;
+    result.height = height;
+    result.pixels.resize(static_cast<size_t>(width) * height * 4);
+    if (source.width <= 0 || source.height <= 0 || width <= 0 || height <= 0) {
+        return result;
+    }
+
+    std::vector<Span> columns, rows;
+    std::vector<float> columnWeights, rowWeights;
+    buildSpans(source.width, width, columns, columnWeights);
+    buildSpans(source.height, height, rows, rowWeights);
+
+    // Horizontal pass: source rows -> width floats per channel
+    std::vector<float> horizontal(static_cast<size_t>(source.height) * width * 4);
+    for (int y = 0; y < source.height; y++) {
+        const unsigned char *row = &source.pixels[static_cast<size_t>(y) * source.width * 4];
+        float *out = &horizontal[static_cast<size_t>(y) * width * 4];
+        for (int x = 0; x < width; x++) {
+            const Span &span = columns[x];
+            const float *w = &columnWeights[span.weights];
+#ifdef THUMBNAIL_USE_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < span.count; k++) {
+                int32_t packed;
+                std::memcpy(&packed, row + (span.start + k) * 4, 4);
+                __m128i bytes = _mm_cvtsi32_si128(packed);
+                __m128 pixel = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+                acc = _mm_add_ps(acc, _mm_mul_ps(pixel, _mm_set1_ps(w[k])));
+            }
+            _mm_storeu_ps(out + x * 4, acc);
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < span.count; k++) {
+                const unsigned char *pixel = row + (span.start + k) * 4;
+                for (int c = 0; c < 4; c++) acc[c] += pixel[c] * w[k];
+            }
+            std::memcpy(out + x * 4, acc, sizeof(acc));
+#endif
+        }
+    }
+
+    // Vertical pass: float rows -> destination bytes
+    for (int y = 0; y < height; y++) {
+        const Span &span = rows[y];
+        const float *w = &rowWeights[span.weights];
+        unsigned char *out = &result.pixels[static_cast<size_t>(y) * width * 4];
+        for (int x = 0; x < width; x++) {
+#ifdef THUMBNAIL_USE_SSE2
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < span.count; k++) {
+                const float *pixel = &horizontal[(static_cast<size_t>(span.start + k) * width + x) * 4];
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(w[k])));
+            }
+            __m128i rounded = _mm_cvtps_epi32(acc);// Round to nearest
+            rounded = _mm_packs_epi32(rounded, rounded);
+            rounded = _mm_packus_epi16(rounded, rounded);// Saturate to 0..255
+            int32_t packed = _mm_cvtsi128_si32(rounded);
+            std::memcpy(out + x * 4, &packed, 4);
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < span.count; k++) {
+                const float *pixel = &horizontal[(static_cast<size_t>(span.start + k) * width + x) * 4];
+                for (int c = 0; c < 4; c++) acc[c] += pixel[c] * w[k];
+            }
+            for (int c = 0; c < 4; c++) {
+                out[x * 4 + c] = static_cast<unsigned char>(std::clamp(acc[c] + 0.5f, 0.0f, 255.0f));
+            }
+#endif
+        }
+    }
+    return result;
+}
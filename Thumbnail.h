@@ -0,0 +1,14 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include "ImageLoader.h"
+#include <string>
+
+// Poster thumbnails are stored next to the poster as <imdbID>.thumb: a small header followed by raw RGBA8 pixels
+std::string ThumbnailPathFor(const std::string& posterPath);
+bool LoadThumbnail(const std::string& posterPath, int width, int height, DecodedImage& thumbnail);
+bool SaveThumbnail(const std::string& posterPath, const DecodedImage& thumbnail);
+
+DecodedImage DownsampleBox(const DecodedImage& source, int width, int height);
+
+#endif // THUMBNAIL_H
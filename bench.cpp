@@ -0,0 +1,640 @@
+#include "LocalCatalog.h"
+#include "MockOmdbServer.h"
+#include "MovieJson.h"
+#include "MovieTable.h"
+#include "OMDbApi.h"
+#include "StressMovies.h"
+#include "TaskScheduler.h"
+#include "Thumbnail.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <regex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+// JSON alias
+using json = nlohmann::json;
+
+// Offline movie catalog, built with MoviesCatalog
+const std::string CATALOG_PATH = "catalog.idx";
+
+// Heap allocations so far, counted for "MoviesBench json" (one relaxed increment per allocation)
+std::atomic<uint64_t> allocationCount{0};
+
+// Counted allocation behind every replaceable operator new below; over-aligned requests use the aligned heap
+static void *countedAllocate(std::size_t size, std::size_t alignment) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void countedFree(void *memory, std::size_t alignment) noexcept {
+#ifdef _WIN32
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        _aligned_free(memory);
+        return;
+    }
+#endif
+    (void) alignment;
+    std::free(memory);
+}
+
+static void *countedNew(std::size_t size, std::size_t alignment) {
+    if (void *memory = countedAllocate(size, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Every form is replaced, so each allocation is counted and every delete matches its new
+void *operator new(std::size_t size) { return countedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new[](std::size_t size) { return countedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return countedNew(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return countedNew(size, static_cast<std::size_t>(alignment)); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *memory) noexcept { countedFree(memory, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void *memory) noexcept { countedFree(memory, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void *memory, std::size_t) noexcept { countedFree(memory, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void *memory, std::size_t) noexcept { countedFree(memory, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void *memory, std::align_val_t alignment) noexcept { countedFree(memory, static_cast<std::size_t>(alignment)); }
+void operator delete[](void *memory, std::align_val_t alignment) noexcept { countedFree(memory, static_cast<std::size_t>(alignment)); }
+void operator delete(void *memory, std::size_t, std::align_val_t alignment) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void *memory, std::size_t, std::align_val_t alignment) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete(void *memory, const std::nothrow_t &) noexcept { countedFree(memory, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { countedFree(memory, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void *memory, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void *memory, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+
+// OMDb responses timed by "MoviesBench json" when no recorded responses are given: a search page and a details response
+const std::string SAMPLE_SEARCH_RESPONSE =
+        R"({"Search":[{"Title":"Star Wars: Episode IV - A New Hope","Year":"1977","imdbID":"tt0076759","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BOTA5NjhiOTAtZWM0ZC00MWNhLThiMzEtZDFkOTk2OTU1ZDJkXkEyXkFqcGdeQXVyMTA4NDI1NTQx._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode V - The Empire Strikes Back","Year":"1980","imdbID":"tt0080684","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BYmU1NDRjNDgtMzhiMi00NjZmLTg5NGItZDNiZjU5NTU4OTE0XkEyXkFqcGdeQXVyNzkwMjQ5NzM@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode VI - Return of the Jedi","Year":"1983","imdbID":"tt0086190","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BOWZlMjFiYzgtMTUzNC00Y2IzLTk1NTMtZmNhMTczNTk0ODk1XkEyXkFqcGdeQXVyNTAyODkwOQ@@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode VII - The Force Awakens","Year":"2015","imdbID":"tt2488496","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BOTAzODEzNDAzMl5BMl5BanBnXkFtZTgwMDU1MTgzNzE@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode I - The Phantom Menace","Year":"1999","imdbID":"tt0120915","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BYTRhNjcwNWQtMGJmMi00NmQyLWE2YzItODVmMTdjNWI0ZDA2XkEyXkFqcGdeQXVyNTAyODkwOQ@@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode III - Revenge of the Sith","Year":"2005","imdbID":"tt0121766","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BNTc4MTc3NTQ5OF5BMl5BanBnXkFtZTcwOTg0NjI4NA@@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode II - Attack of the Clones","Year":"2002","imdbID":"tt0121765","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BMDAzM2M0Y2UtZjRmZi00MzVlLTg4MjEtOTE3NzU5ZDVlMTU5XkEyXkFqcGdeQXVyNDUyOTg3Njg@._V1_SX300.jpg"},)"
+        R"({"Title":"Rogue One: A Star Wars Story","Year":"2016","imdbID":"tt3748528","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BMjEwMzMxODIzOV5BMl5BanBnXkFtZTgwNzg3OTAzMDI@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode VIII - The Last Jedi","Year":"2017","imdbID":"tt2527336","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BMjQ1MzcxNjg4N15BMl5BanBnXkFtZTgwNzgwMjY4MzI@._V1_SX300.jpg"},)"
+        R"({"Title":"Star Wars: Episode IX - The Rise of Skywalker","Year":"2019","imdbID":"tt2527338","Type":"movie","Poster":"https://m.media-amazon.com/images/M/MV5BMDljNTQ5ODItZmQwMy00M2ExLTljOTQtZTVjNGE2NTg0NGIxXkEyXkFqcGdeQXVyODkzNTgxMDg@._V1_SX300.jpg"}],)"
+        R"("totalResults":"890","Response":"True"})";
+const std::string SAMPLE_DETAILS_RESPONSE =
+        R"({"Title":"Star Wars: Episode IV - A New Hope","Year":"1977","Rated":"PG","Released":"25 May 1977","Runtime":"121 min",)"
+        R"("Genre":"Action, Adventure, Fantasy","Director":"George Lucas","Writer":"George Lucas",)"
+        R"("Actors":"Mark Hamill, Harrison Ford, Carrie Fisher",)"
+        R"("Plot":"Luke Skywalker joins forces with a Jedi Knight, a cocky pilot, a Wookiee and two droids to save the galaxy from the Empire's world-destroying battle station, while also attempting to rescue Princess Leia from the mysterious Darth Vader.",)"
+        R"("Language":"English","Country":"United States","Awards":"Won 6 Oscars. 65 wins & 31 nominations total",)"
+        R"("Poster":"https://m.media-amazon.com/images/M/MV5BOTA5NjhiOTAtZWM0ZC00MWNhLThiMzEtZDFkOTk2OTU1ZDJkXkEyXkFqcGdeQXVyMTA4NDI1NTQx._V1_SX300.jpg",)"
+        R"("Ratings":[{"Source":"Internet Movie Database","Value":"8.6/10"},{"Source":"Rotten Tomatoes","Value":"93%"},{"Source":"Metacritic","Value":"90/100"}],)"
+        R"("Metascore":"90","imdbRating":"8.6","imdbVotes":"1,448,216","imdbID":"tt0076759","Type":"movie","DVD":"N/A",)"
+        R"("BoxOffice":"$460,998,507","Production":"N/A","Website":"N/A","Response":"True"})";
+
+
+// Milliseconds elapsed since start
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs the benchmark in a fresh directory, so the caches start cold and the user's caches stay untouched
+static bool enterScratchDirectory(const std::string &name) {
+#ifdef _WIN32
+    int processId = _getpid();
+#else
+    int processId = getpid();
+#endif
+    fs::path directory = fs::temp_directory_path() / (name + "-" + std::to_string(processId));
+    std::error_code ec;
+    fs::remove_all(directory, ec);
+    fs::create_directories(directory, ec);
+    if (!ec) {
+        fs::current_path(directory, ec);
+    }
+    if (ec) {
+        std::cerr << "ERROR: Could not create " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    std::cout << "Working in " << directory << std::endl;
+    return true;
+}
+
+/**
+ * @brief Compares fetching a result page's details and posters one by one with fanning them out.
+ *
+ * Both passes run against a MockOmdbServer that delays every response by the
+ * given latency and use distinct queries, so no request is answered from a
+ * cache. The sequential pass fetches the page, then each movie's details and
+ * poster on the calling thread, as the app did before the task scheduler;
+ * the pooled pass uses fetchSearchPage() and completeMovies() as the app does
+ * now. The ideal pooled time is two round trips: the page, then all detail
+ * and poster requests at once.
+ */
+static int benchFanout(int argc, char **argv) {
+    int latencyMs = 100;
+    size_t jobs = 16;
+    int queries = 5;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            latencyMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " fanout [--latency <ms>] [--jobs <count>] [--queries <count>]" << std::endl;
+            return -1;
+        }
+    }
+    if (latencyMs < 0 || jobs == 0 || queries <= 0 || !enterScratchDirectory("moviesbench-fanout")) {
+        return -1;
+    }
+
+    MockOmdbServer server{std::chrono::milliseconds(latencyMs)};
+    if (!server.start()) {
+        return -1;
+    }
+    // Only the latency limits the mock; the rate limiter must not
+    RequestLimiter::Config limits;
+    limits.perSecond = 1e6;
+    limits.burst = 1e6;
+    limits.perDay = 0;
+    limits.maxConcurrency = jobs;
+    TaskScheduler scheduler(jobs);
+    OMDbApi api("mock", scheduler, "omdb_cache.bin", limits, server.hosts());
+    CancellationToken token;
+
+    double sequentialMs = 0.0;
+    for (int q = 0; q < queries; q++) {
+        auto start = std::chrono::steady_clock::now();
+        auto page = api.fetchSearchPage("sequential" + std::to_string(q), 1, token);
+        if (!page) {
+            std::cerr << "ERROR: Mock search failed" << std::endl;
+            return -1;
+        }
+        for (const Movie &movie: page->movies) {
+            api.lookupMovie(movie.imdbID, token);
+            api.fetchPoster(movie.imdbID, token);
+        }
+        sequentialMs += millisecondsSince(start);
+    }
+
+    double pooledMs = 0.0;
+    for (int q = 0; q < queries; q++) {
+        auto start = std::chrono::steady_clock::now();
+        auto page = api.fetchSearchPage("pooled" + std::to_string(q), 1, token);
+        if (!page) {
+            std::cerr << "ERROR: Mock search failed" << std::endl;
+            return -1;
+        }
+        api.completeMovies(page->movies, [](const Movie &) {}, [](const std::string &, const std::string &) {}, token);
+        pooledMs += millisecondsSince(start);
+    }
+    scheduler.shutdown();
+    server.stop();
+
+    std::cout << "Fan-out of one result page (10 movies, 1 search + 10 details + 10 posters), "
+              << latencyMs << " ms latency, " << jobs << " workers, " << queries << " queries:" << std::endl;
+    std::cout << "  Sequential: " << sequentialMs / queries << " ms per page" << std::endl;
+    std::cout << "  Pooled:     " << pooledMs / queries << " ms per page (ideal " << 2 * latencyMs << " ms)" << std::endl;
+    std::cout << "  Speedup:    " << sequentialMs / pooledMs << "x" << std::endl;
+    std::cout << "  Mock requests served: " << server.requests() << std::endl;
+    return 0;
+}
+
+// Search responses of 10 movies with their details merged in, as the old parse path saw them.
+// Every 7th rating is "N/A" and every 11th title contains parentheses, as in real results.
+static std::vector<std::string> makeSyntheticResponses(size_t count) {
+    static const char *genres[] = {"Drama", "Action, Adventure, Sci-Fi", "Comedy, Romance", "Horror, Thriller"};
+    std::vector<std::string> responses;
+    responses.reserve(count);
+    for (size_t r = 0; r < count; r++) {
+        json results = json::array();
+        for (size_t i = 0; i < 10; i++) {
+            size_t n = r * 10 + i;
+            std::string title = "Synthetic Movie " + std::to_string(n);
+            if (n % 11 == 0) title += " (Director's Cut)";
+            results.push_back({{"Title", title},
+                               {"Year", std::to_string(1950 + n % 75)},
+                               {"imdbID", "tt" + std::to_string(1000000 + n)},
+                               {"Type", "movie"},
+                               {"Poster", "https://m.media-amazon.com/images/M/" + std::to_string(n) + ".jpg"},
+                               {"Genre", genres[n % 4]},
+                               {"imdbRating", n % 7 == 0 ? "N/A" : std::to_string(1 + n % 9) + "." + std::to_string(n % 10)}});
+        }
+        responses.push_back(json({{"Search", results}, {"totalResults", "1000"}, {"Response", "True"}}).dump());
+    }
+    return responses;
+}
+
+// The parse path before typed results: OMDbApi formatted every movie into a
+// "Title (Year) (Genre) (Rating)(imdbID)" string and main.cpp matched each
+// one back into a Movie with a regex built per call
+static std::vector<Movie> parseThroughStrings(const std::string &body) {
+    std::vector<std::string> movieTitles;
+    json response = json::parse(body);
+    for (const auto &movie: response["Search"]) {
+        std::string title = movie.value("Title", "Unknown");
+        std::string year = movie.value("Year", "Unknown");
+        std::string imdbID = movie.value("imdbID", "");
+        std::string genre = movie.value("Genre", "Unknown");
+        std::string imdbRating = movie.value("imdbRating", "Unknown");
+        movieTitles.push_back(title + " (" + year + ")" + " (" + genre + ")" + " (" + imdbRating + ")" + "(" + imdbID + ")");
+    }
+
+    std::vector<Movie> results;
+    std::regex moviePattern(R"(^(.+?)\s*\((\d{4})\)\s*\((.*?)\)\s*\(([\d.]+)\)\s*\((\w+)\))");
+    std::smatch match;
+    for (const auto &movie: movieTitles) {
+        if (std::regex_match(movie, match, moviePattern)) {
+            Movie &parsed = results.emplace_back();
+            parsed.title = match[1].str();
+            parsed.year = match[2].str();
+            parsed.genre = match[3].str();
+            parsed.imdbRating = match[4].str();
+            parsed.imdbID = match[5].str();
+        }
+    }
+    return results;
+}
+
+// The typed path: fields go straight from the JSON into Movie records
+static std::vector<Movie> parseTyped(const std::string &body) {
+    OMDbResponse response = ParseOMDbResponse(body);
+    for (Movie &movie: response.movies) {
+        movie.rating = ParseImdbRating(movie.imdbRating);
+    }
+    return std::move(response.movies);
+}
+
+/**
+ * @brief Compares the old string-and-regex parse path of search results with the typed one.
+ *
+ * Both paths parse the same synthetic responses; the best of three passes is
+ * reported, with the number of movies each path returned; the old path drops
+ * every movie rated "N/A".
+ */
+static int benchParse(int argc, char **argv) {
+    size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000;
+    if (count == 0) {
+        std::cerr << "Usage: " << argv[0] << " parse [response count]" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> responses = makeSyntheticResponses(count);
+
+    auto run = [&](std::vector<Movie> (*parse)(const std::string &), size_t &movies) {
+        double best = 0.0;
+        for (int pass = 0; pass < 3; pass++) {
+            movies = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const std::string &body: responses) {
+                movies += parse(body).size();
+            }
+            double ms = millisecondsSince(start);
+            best = pass == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    };
+    size_t oldMovies = 0;
+    size_t typedMovies = 0;
+    double oldMs = run(parseThroughStrings, oldMovies);
+    double typedMs = run(parseTyped, typedMovies);
+
+    std::cout << "Parsing " << count << " search responses of 10 movies:" << std::endl;
+    std::cout << "  Strings + regex: " << oldMs << " ms (" << oldMs * 1000.0 / count << " us per response), "
+              << oldMovies << " movies" << std::endl;
+    std::cout << "  Typed:           " << typedMs << " ms (" << typedMs * 1000.0 / count << " us per response), "
+              << typedMovies << " movies" << std::endl;
+    std::cout << "  Speedup:         " << oldMs / typedMs << "x" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Compares loading a poster by decoding and resizing the JPEG with reading its stored thumbnail.
+ *
+ * The posters are copied into a scratch directory first, so no thumbnails
+ * are written next to the user's posters. Each poster is loaded the old way
+ * (DecodeImageFile() and DownsampleBox(), what TextureLoader does the first
+ * time) and the new way (LoadThumbnail() of the .thumb stored by
+ * SaveThumbnail()), at the atlas's default slot size of 100x150.
+ */
+static int benchThumbnails(int argc, char **argv) {
+    const int width = 100;
+    const int height = 150;
+    int iterations = 50;
+    std::vector<fs::path> posters;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            posters.push_back(fs::absolute(argv[i]));// Resolved before entering the scratch directory
+        }
+    }
+    if (posters.empty() || iterations <= 0) {
+        std::cerr << "Usage: " << argv[0] << " thumbnails <poster.jpg>... [--iterations <count>]" << std::endl;
+        return -1;
+    }
+    if (!enterScratchDirectory("moviesbench-thumbnails")) {
+        return -1;
+    }
+
+    double decodeTotal = 0.0;
+    double thumbnailTotal = 0.0;
+    for (const fs::path &source: posters) {
+        std::string poster = source.filename().string();
+        std::error_code ec;
+        fs::copy_file(source, poster, fs::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "ERROR: Could not copy " << source << ": " << ec.message() << std::endl;
+            return -1;
+        }
+
+        DecodedImage thumbnail;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            DecodedImage image;
+            if (!DecodeImageFile(poster, image)) {
+                return -1;
+            }
+            thumbnail = DownsampleBox(image, width, height);
+        }
+        double decodeUs = millisecondsSince(start) * 1000.0 / iterations;
+
+        if (!SaveThumbnail(poster, thumbnail)) {
+            return -1;
+        }
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            if (!LoadThumbnail(poster, width, height, thumbnail)) {
+                std::cerr << "ERROR: Could not load the thumbnail of " << poster << std::endl;
+                return -1;
+            }
+        }
+        double thumbnailUs = millisecondsSince(start) * 1000.0 / iterations;
+
+        std::cout << poster << " (" << fs::file_size(poster) / 1024 << " KB): decode + resize " << decodeUs
+                  << " us, thumbnail " << thumbnailUs << " us (" << fs::file_size(ThumbnailPathFor(poster)) / 1024
+                  << " KB), " << decodeUs / thumbnailUs << "x" << std::endl;
+        decodeTotal += decodeUs;
+        thumbnailTotal += thumbnailUs;
+    }
+    std::cout << "Per poster: decode + resize " << decodeTotal / posters.size() << " us, thumbnail "
+              << thumbnailTotal / posters.size() << " us" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Times indexing and sorting synthetic movies with MovieTable and prints the results.
+ *
+ * The movies are those of "MoviesApp --stress", so the numbers match what the
+ * stress test's table does when a column header is clicked.
+ */
+static int benchSort(int argc, char **argv) {
+    size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50000;
+    if (count < 100) {
+        std::cerr << "Usage: " << argv[0] << " sort [movie count, at least 100]" << std::endl;
+        return -1;
+    }
+    std::vector<Movie> movies = MakeStressMovies(count);
+
+    MovieTable table;
+    auto start = std::chrono::steady_clock::now();
+    table.sync(movies, true);
+    auto elapsedMs = [&start]() {
+        double ms = millisecondsSince(start);
+        start = std::chrono::steady_clock::now();
+        return ms;
+    };
+    std::cout << "Sort benchmark: indexed " << movies.size() << " rows in " << elapsedMs() << " ms" << std::endl;
+    const std::pair<MovieTable::Column, const char *> columns[] = {
+            {MovieTable::Title, "title"}, {MovieTable::Year, "year"}, {MovieTable::Rating, "rating"}};
+    for (const auto &[column, name]: columns) {
+        table.sortBy(column, true);
+        double ascendingMs = elapsedMs();
+        table.sortBy(column, false);
+        double descendingMs = elapsedMs();
+        std::cout << "Sort benchmark: by " << name << " " << ascendingMs << " ms ascending, " << descendingMs
+                  << " ms descending" << std::endl;
+    }
+    const std::vector<MovieTable::SortKey> multiKey = {
+            {MovieTable::Year, false}, {MovieTable::Rating, false}, {MovieTable::Title, true}};
+    table.sortBy(multiKey);
+    std::cout << "Sort benchmark: by year, rating and title " << elapsedMs() << " ms" << std::endl;
+
+    // Streaming: the last 1% of the rows arrives after the table was sorted
+    std::vector<Movie> head(movies.begin(), movies.begin() + static_cast<std::ptrdiff_t>(movies.size() - movies.size() / 100));
+    table.sync(head, true);
+    table.sortBy(multiKey);
+    elapsedMs();
+    table.sync(movies, false);
+    std::cout << "Sort benchmark: merged " << movies.size() / 100 << " streamed rows in " << elapsedMs() << " ms"
+              << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Times catalog searches, exact and typo-tolerant, on catalog.idx and prints the results.
+ *
+ * The queries are the arguments, or a set of misspelled titles if there are none.
+ */
+static int benchCatalog(int argc, char **argv) {
+    LocalCatalog catalog;
+    if (!catalog.open(CATALOG_PATH)) {
+        std::cerr << "No movie catalog, build it with MoviesCatalog first" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> queries(argv + 2, argv + argc);
+    if (queries.empty()) {
+        queries = {"interstelar", "godfathr", "shawshenk redemtion", "pulp fictoin", "lord of the rigns", "star wa"};
+    }
+    const int runs = 20;
+    for (const std::string &query: queries) {
+        double totalMs = 0.0;
+        double worstMs = 0.0;
+        std::vector<Movie> found;
+        for (int run = 0; run < runs; run++) {
+            auto start = std::chrono::steady_clock::now();
+            found = catalog.search(query, 100);
+            if (found.empty()) {
+                found = catalog.searchFuzzy(query, 100);
+            }
+            double ms = millisecondsSince(start);
+            totalMs += ms;
+            worstMs = std::max(worstMs, ms);
+        }
+        std::cout << "\"" << query << "\": " << found.size() << " results, avg " << totalMs / runs << " ms, worst "
+                  << worstMs << " ms" << (found.empty() ? "" : ", best match: " + found.front().title) << std::endl;
+    }
+    return 0;
+}
+
+// The DOM path the app used before ParseOMDbResponse(): one entry of a "Search" array into a Movie
+static Movie movieFromSearchResult(const json &result) {
+    Movie movie;
+    movie.title = result.value("Title", "Unknown");// Get movie title
+    movie.year = result.value("Year", "Unknown");  // Get movie year
+    movie.imdbID = result.value("imdbID", "");     // Get IMDb ID
+    movie.posterUrl = result.value("Poster", "");  // Get poster URL
+    movie.releaseYear = ParseReleaseYear(movie.year);
+    return movie;
+}
+
+// The DOM path for the genre and rating of a details response
+static void applyMovieDetails(Movie &movie, const json &details) {
+    movie.genre = details.value("Genre", "Unknown");          // Get movie genre
+    movie.imdbRating = details.value("imdbRating", "Unknown");// Get IMDb rating
+    movie.rating = ParseImdbRating(movie.imdbRating);
+}
+
+/**
+ * @brief Times extracting movies from OMDb responses, DOM against SAX, and prints the results.
+ *
+ * The DOM path parses each response into an nlohmann::json tree and copies the
+ * fields out of it, as the app did before ParseOMDbResponse(); the SAX path is
+ * ParseOMDbResponse(). The arguments are files holding one recorded OMDb
+ * response each; a sample search page and details response are used if there
+ * are none.
+ */
+static int benchJson(int argc, char **argv) {
+    std::vector<std::string> paths(argv + 2, argv + argc);
+    std::vector<std::pair<std::string, std::string>> payloads;// Name and body
+    if (paths.empty()) {
+        payloads = {{"search page", SAMPLE_SEARCH_RESPONSE}, {"details", SAMPLE_DETAILS_RESPONSE}};
+    }
+    for (const std::string &path: paths) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "ERROR: Cannot read " << path << std::endl;
+            continue;
+        }
+        payloads.emplace_back(path, std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+    }
+
+    const int runs = 2000;
+    for (const auto &[name, body]: payloads) {
+        auto parseDom = [&body]() {
+            std::vector<Movie> found;
+            nlohmann::json response = nlohmann::json::parse(body, nullptr, false);
+            if (response.contains("Search")) {
+                for (const auto &entry: response["Search"]) {
+                    found.push_back(movieFromSearchResult(entry));
+                }
+            } else if (response.is_object()) {
+                found.push_back(movieFromSearchResult(response));
+                applyMovieDetails(found.back(), response);
+            }
+            return found.size();
+        };
+        auto parseSax = [&body]() {
+            OMDbResponse response = ParseOMDbResponse(body);
+            return response.hasSearch ? response.movies.size() : size_t(response.valid ? 1 : 0);
+        };
+        // Average time in microseconds and allocations of one parse
+        auto measure = [](auto &&parse, size_t &movieCount) {
+            uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            for (int run = 0; run < runs; run++) {
+                movieCount = parse();
+            }
+            double us = millisecondsSince(start) * 1000.0;
+            return std::make_pair(us / runs, static_cast<double>(allocationCount.load(std::memory_order_relaxed) - allocationsBefore) / runs);
+        };
+        size_t domMovies = 0;
+        size_t saxMovies = 0;
+        auto [domUs, domAllocations] = measure(parseDom, domMovies);
+        auto [saxUs, saxAllocations] = measure(parseSax, saxMovies);
+        std::cout << "JSON benchmark: " << name << " (" << body.size() << " bytes, " << saxMovies << " movies): DOM "
+                  << domUs << " us, " << domAllocations << " allocations; SAX " << saxUs << " us, " << saxAllocations
+                  << " allocations" << (domMovies != saxMovies ? " (movie counts differ)" : "") << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * @brief Entry point of the benchmarks.
+ *
+ * Usage: MoviesBench fanout [--latency <ms>] [--jobs <count>] [--queries <count>]
+ *        MoviesBench parse [response count]
+ *        MoviesBench thumbnails <poster.jpg>... [--iterations <count>]
+ *        MoviesBench sort [movie count]
+ *        MoviesBench catalog [query...]
+ *        MoviesBench json [response.json...]
+ *
+ * fanout: sequential vs. pooled fetching of a result page against a local
+ *         mock OMDb server with the given latency (see benchFanout()).
+ * parse:  old string-and-regex vs. typed parsing of search responses (see benchParse()).
+ * thumbnails: JPEG decode and resize vs. stored thumbnail per poster (see benchThumbnails()).
+ * sort:   indexing, sorting and merging streamed rows of the results table (see benchSort()).
+ * catalog: exact and typo-tolerant searches of catalog.idx (see benchCatalog()).
+ * json:   DOM vs. SAX extraction of OMDb responses, with heap allocations (see benchJson()).
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments.
+ * @return int Returns 0 if the benchmark ran, or -1 otherwise.
+ */
+int main(int argc, char **argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "fanout") {
+        return benchFanout(argc, argv);
+    }
+    if (mode == "parse") {
+        return benchParse(argc, argv);
+    }
+    if (mode == "thumbnails") {
+        return benchThumbnails(argc, argv);
+    }
+    if (mode == "sort") {
+        return benchSort(argc, argv);
+    }
+    if (mode == "catalog") {
+        return benchCatalog(argc, argv);
+    }
+    if (mode == "json") {
+        return benchJson(argc, argv);
+    }
+    std::cerr << "Usage: " << argv[0] << " fanout [--latency <ms>] [--jobs <count>] [--queries <count>]" << std::endl;
+    std::cerr << "       " << argv[0] << " parse [response count]" << std::endl;
+    std::cerr << "       " << argv[0] << " thumbnails <poster.jpg>... [--iterations <count>]" << std::endl;
+    std::cerr << "       " << argv[0] << " sort [movie count]" << std::endl;
+    std::cerr << "       " << argv[0] << " catalog [query...]" << std::endl;
+    std::cerr << "       " << argv[0] << " json [response.json...]" << std::endl;
+    return -1;
+}
@@ -0,0 +1,43 @@
+#include "LocalCatalog.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Offline movie catalog read by MoviesApp, MoviesServer and MoviesEnrich from their working directory
+const std::string CATALOG_PATH = "catalog.idx";
+
+
+/**
+ * @brief Entry point of the catalog builder.
+ *
+ * Usage: MoviesCatalog <title.basics.tsv> [title.ratings.tsv] [--output <catalog.idx>]
+ *
+ * Indexes the IMDb dataset dumps into catalog.idx (see LocalCatalog::build()).
+ * Without the ratings dump, movies are not ranked by popularity.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments.
+ * @return int Returns 0 if the catalog was written, or -1 otherwise.
+ */
+int main(int argc, char **argv) {
+    std::string basicsPath;
+    std::string ratingsPath;
+    std::string outputPath = CATALOG_PATH;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (basicsPath.empty()) {
+            basicsPath = argv[i];
+        } else if (ratingsPath.empty()) {
+            ratingsPath = argv[i];
+        } else {
+            basicsPath.clear();
+            break;
+        }
+    }
+    if (basicsPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <title.basics.tsv> [title.ratings.tsv] [--output <catalog.idx>]" << std::endl;
+        return -1;
+    }
+    return LocalCatalog::build(basicsPath, ratingsPath, outputPath) ? 0 : -1;
+}
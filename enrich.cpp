@@ -0,0 +1,117 @@
+#include "BatchEnricher.h"
+#include "LocalCatalog.h"
+#include "OMDbApi.h"
+#include "TaskScheduler.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// API Key used when OMDB_API_KEY is not set (Replace with your real OMDb API key)
+const std::string DEFAULT_API_KEY = "133d7f7e";
+// Offline movie catalog, built with MoviesCatalog
+const std::string CATALOG_PATH = "catalog.idx";
+
+BatchEnricher *runningEnricher = nullptr;// Cancelled on Ctrl+C, so the lines resolved so far are still written
+
+
+/**
+ * @brief Entry point of the bulk enrichment tool.
+ *
+ * Usage: MoviesEnrich <input.csv|input.jsonl> <output.jsonl> [--jobs <count>] [--no-posters]
+ *                     [--rate <requests per second>] [--daily-budget <requests>]
+ *
+ * Resolves every title or IMDb ID of the input to a movie with genre, rating
+ * and poster (see BatchEnricher), writes one JSON line per input line and
+ * prints the throughput and per-stage latencies at the end. An input of "-"
+ * is read from stdin; the output must be a file, as progress is logged to
+ * stdout. The OMDb API key is read from the OMDB_API_KEY environment variable.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments.
+ * @return int Returns 0 if every line was processed, or -1 otherwise.
+ */
+int main(int argc, char **argv) {
+    std::string inputPath;
+    std::string outputPath;
+    BatchEnricher::Options options;
+    size_t jobs = 16;
+    RequestLimiter::Config limits;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--no-posters") == 0) {
+            options.posters = false;
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            limits.perSecond = std::strtod(argv[++i], nullptr);
+            limits.burst = limits.perSecond;
+        } else if (std::strcmp(argv[i], "--daily-budget") == 0 && i + 1 < argc) {
+            limits.perDay = std::strtoull(argv[++i], nullptr, 10);
+        } else if (inputPath.empty()) {
+            inputPath = argv[i];
+        } else if (outputPath.empty()) {
+            outputPath = argv[i];
+        } else {
+            inputPath.clear();
+            break;
+        }
+    }
+    if (inputPath.empty() || outputPath.empty() || jobs == 0) {
+        std::cerr << "Usage: " << argv[0] << " <input.csv|input.jsonl> <output.jsonl> [--jobs <count>] [--no-posters]"
+                  << " [--rate <requests per second>] [--daily-budget <requests>]" << std::endl;
+        return -1;
+    }
+
+    std::ifstream inputFile;
+    if (inputPath != "-") {
+        inputFile.open(inputPath);
+        if (!inputFile) {
+            std::cerr << "ERROR: Failed to open " << inputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ofstream outputFile(outputPath, std::ios::trunc);
+    if (!outputFile) {
+        std::cerr << "ERROR: Failed to create " << outputPath << std::endl;
+        return -1;
+    }
+    const char *apiKey = std::getenv("OMDB_API_KEY");
+
+    // One worker and one connection per host for each concurrent lookup
+    TaskScheduler scheduler(jobs);
+    limits.maxConcurrency = jobs;
+    OMDbApi api(apiKey ? apiKey : DEFAULT_API_KEY, scheduler, "omdb_cache.bin", limits);
+    LocalCatalog catalog;
+    catalog.open(CATALOG_PATH);
+
+    // Keep the workers busy while finished lines wait for slower ones ahead of them
+    options.maxInFlight = jobs * 4;
+    BatchEnricher enricher(api, scheduler, catalog.isOpen() ? &catalog : nullptr, options);
+    runningEnricher = &enricher;
+    std::signal(SIGINT, [](int) { runningEnricher->cancel(); });
+
+    BatchEnricher::Report report;
+    bool complete = enricher.run(inputPath == "-" ? std::cin : inputFile, outputFile, report);
+    std::signal(SIGINT, SIG_DFL);
+    runningEnricher = nullptr;
+    scheduler.shutdown();
+
+    report.print(std::cerr);
+    ResponseCache::Stats cache = api.responseCacheStats();
+    std::cerr << "Response cache: " << cache.hits << " hits, " << cache.misses << " misses" << std::endl;
+    auto requests = api.requestStats();
+    auto posters = api.posterStats();
+    std::cerr << "OMDb requests: " << requests.issued << " issued, " << requests.coalesced << " coalesced; posters: "
+              << posters.issued << " fetched, " << posters.coalesced << " coalesced" << std::endl;
+    RequestLimiter::State limiter = api.limiterState();
+    std::cerr << "Request limiter: " << limiter.usedToday << " of " << limiter.dailyBudget << " daily requests used, "
+              << limiter.throttled << " throttled, " << limiter.refused << " refused, " << limiter.retries << " retries, "
+              << "concurrency limit " << static_cast<int>(limiter.concurrencyLimit)
+              << (limiter.quotaExhausted ? ", quota exhausted" : "") << std::endl;
+    if (!complete) {
+        std::cerr << "ERROR: Stopped before the end of the input" << std::endl;
+    }
+    return complete ? 0 : -1;
+}
@@ -1,109 +1,98 @@
 #include "GuiManager.h"
+#include "LocalCatalog.h"
 #include "OMDbApi.h"
+#include "PagedSearch.h"
+#include "ResultFeed.h"
+#include "StressMovies.h"
+#include "TaskScheduler.h"
 #include <GLFW/glfw3.h>
-#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>
-#include <regex>
 #include <string>
-#include <thread>
 #include <vector>
 
 // Global variables
 std::string searchQuery = "";        // Search query string
 std::vector<Movie> movies;           // Vector to store movie data
 std::mutex moviesMutex;              // Mutex to protect access to movie data
-std::atomic<bool> isSearching(false);// Atomic flag to prevent race conditions
+ResultFeed resultFeed;               // Streams search results from the fetch threads to the GUI
 
 // API Key (Replace with your real OMDb API key)
 const std::string API_KEY = "133d7f7e";
+// Offline movie catalog, built with MoviesCatalog
+const std::string CATALOG_PATH = "catalog.idx";
 
 
 /**
- * @brief Searches for movies using the OMDb API and updates the provided movie list.
+ * @brief Starts a search for movies using the OMDb API and streams the results to the GUI.
  *
- * This function performs a search for movies based on the given query string using the OMDb API.
- * It updates the provided vector of movies with the search results and ensures thread safety
- * using a mutex. The function also uses an atomic boolean to indicate the search status.
+ * The previous search is cancelled instead of waited for. The new search gets a generation
+ * ID from the result feed, so a superseded search cannot overwrite the newer one's results
+ * even if a response arrives late. Its first page is fetched right away; later pages are
+ * fetched as the user scrolls, see PagedSearch::ensureRows().
  *
  * @param api Reference to the OMDbApi object used to perform the search.
+ * @param scheduler Reference to the task scheduler running the requests.
  * @param query The search query string used to find movies.
- * @param movies Reference to a vector of Movie objects to be updated with the search results.
- * @param moviesMutex Reference to a mutex used to ensure thread-safe access to the movies vector.
- * @param isSearching Reference to an atomic boolean used to indicate whether a search is in progress.
+ * @param feed Reference to the result feed drained by the GUI every frame.
+ * @param previous The search being replaced, or nullptr.
+ * @param catalog Local catalog answering the query before OMDb, or nullptr.
+ * @return The new search.
  */
-void searchMovies(OMDbApi &api, std::string query, std::vector<Movie> &movies, std::mutex &moviesMutex, std::atomic<bool> &isSearching) {
-    // Mark search as active to prevent concurrent searches from main thread
-    isSearching.store(true, std::memory_order_relaxed);
-    // Perform movie search using the OMDb API
-    std::vector<std::string> movieResults = api.searchMovies(query);
-    // Check if any movies were found
-    if (movieResults.empty()) {
-        std::cerr << " No movies found for query: " << query << std::endl;
-    } else {
-        std::cout << " Received " << movieResults.size() << " movies from API" << std::endl;
+std::shared_ptr<PagedSearch> startSearch(OMDbApi &api, TaskScheduler &scheduler, const std::string &query, ResultFeed &feed,
+                                         const std::shared_ptr<PagedSearch> &previous, const LocalCatalog *catalog) {
+    // Abandon the previous search instead of waiting for its downloads
+    if (previous) {
+        previous->cancel();
     }
-    // Parse movie results and update the movie list
-    std::vector<Movie> results;
-    // Regular expression pattern to match movie data
-    std::regex moviePattern(R"(^(.+?)\s*\((\d{4})\)\s*\((.*?)\)\s*\(([\d.]+)\)\s*\((\w+)\))");
-    // Regular expression match object
-    std::smatch match;
-    // Iterate over each movie string and parse the data
-    for (const auto &movie: movieResults) {
-        // Remove newline and carriage return characters from the movie string
-        std::string cleanMovieStr = movie;
-        cleanMovieStr.erase(std::remove(cleanMovieStr.begin(), cleanMovieStr.end(), '\n'), cleanMovieStr.end());
-        cleanMovieStr.erase(std::remove(cleanMovieStr.begin(), cleanMovieStr.end(), '\r'), cleanMovieStr.end());
-
-        // Remove leading and trailing whitespace from the movie string
-
-
-        // Check if the movie string matches the expected pattern
-        if (std::regex_match(cleanMovieStr, match, moviePattern)) {
-            std::string title = match[1].str();     // Group 1: Movie Title
-            std::string year = match[2].str();      // Group 2: Year
-            std::string genre = match[3].str();     // Group 3: Genre
-            std::string imdbRating = match[4].str();// Group 4: IMDb Rating
-            std::string posterUrl = match[5].str(); // Group 5: Poster URL
-            // Add the movie data to the results vector
-            results.push_back({title, year, genre, imdbRating, posterUrl});
-        } else {
-            // Print an error message if the movie string does not match the expected pattern
-            std::cerr << "ERROR: Failed to parse movie string: " << movie << std::endl;
-        }
-    }
-
-    // Lock and update movie data
-    {
-        std::lock_guard<std::mutex> lock(moviesMutex);
-        movies = results;
-    }
-
-    // Mark search as complete
-    isSearching.store(false, std::memory_order_relaxed);
+    uint64_t generation = feed.beginSearch();
+    auto search = std::make_shared<PagedSearch>(api, scheduler, feed, query, generation, catalog);
+    search->start();
+    return search;
 }
 
 /**
  * @brief Entry point of the application.
  *
  * This function initializes the GLFW library, creates a window, and sets up the main loop
- * for the application. It also initializes the GUI manager and the OMDb API, and handles
- * the search functionality in a separate thread.
+ * for the application. It also initializes the task scheduler, the GUI manager and the OMDb API,
+ * and runs every search as a task on the scheduler.
+ *
+ * Running with "--stress [count]" fills the results table with count synthetic movies
+ * (50000 by default) and shows the frame time overlay; the frame time summary is printed on exit.
+ *
+ * When catalog.idx (built with MoviesCatalog) exists, searches are answered from it and only go
+ * to OMDb when it has no match.
  *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments.
  * @return int Returns 0 on successful execution, or -1 if initialization fails.
  *
  * The main loop performs the following tasks:
- * - Polls for window events.
- * - Checks if a new search query is available and no search is currently running.
- * - If conditions are met, starts a new search thread to fetch movie data from the OMDb API.
+ * - Waits for window events, results from background tasks, or the next timed redraw.
+ * - Checks if a new search query is available.
+ * - If so, cancels the running search and starts a new one to fetch movie data from the OMDb API.
+ * - Lets the current search fetch more pages once the user scrolls close to the end of the results.
  * - Renders the GUI with the current state of the application.
- * - Sleeps for a short duration to prevent excessive CPU usage.
  *
- * Before exiting, the function ensures that any running search thread is joined, and cleans up
+ * The loop sleeps while nothing changes instead of redrawing at a fixed rate; background
+ * tasks wake it with glfwPostEmptyEvent() when results or posters arrive.
+ *
+ * Before exiting, the function cancels any running search, shuts the scheduler down, and cleans up
  * the GLFW resources.
  */
-int main() {
+int main(int argc, char **argv) {
+    // Stress mode: "--stress [count]"
+    size_t stressCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--stress") == 0) {
+            stressCount = (i + 1 < argc) ? std::strtoull(argv[++i], nullptr, 10) : 50000;
+        }
+    }
+
     // Initialize GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -120,48 +109,57 @@ int main() {
     // Enable vertical sync (V-Sync)
     glfwSwapInterval(1);
 
-    // Initialize GUI Manager
-    GuiManager gui(window);
+    // Worker threads for searches, detail and poster requests and poster decodes
+    TaskScheduler scheduler;
+
+    // Initialize GUI Manager (destroyed explicitly while the GL context is still alive)
+    auto gui = std::make_unique<GuiManager>(window, scheduler);
+    if (stressCount > 0) {
+        std::lock_guard<std::mutex> lock(moviesMutex);
+        movies = MakeStressMovies(stressCount);
+        gui->setShowFrameStats(true);
+        std::cout << " Stress mode: " << movies.size() << " synthetic movies" << std::endl;
+    }
 
     // Initialize OMDb API
-    OMDbApi api(API_KEY);
-    // Search thread and query variables
-    std::thread searchThread;
+    OMDbApi api(API_KEY, scheduler);
+    gui->setApi(&api);// Request counters for the F3 overlay
+    // Searches are answered offline when the catalog has been built
+    LocalCatalog catalog;
+    catalog.open(CATALOG_PATH);
+    // Wake the main loop when search results arrive
+    resultFeed.setWakeCallback(glfwPostEmptyEvent);
+    std::shared_ptr<PagedSearch> search;// The newest search; superseded searches wind down in the background
     // Copy of the search query for display purposes in the GUI (to prevent flickering)
     std::string queryCopy = "\0";
     // Main loop for the application
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();// Poll for window events
-        // Check if searchQuery is updated and no search is running
-        if (!searchQuery.empty() && isSearching.load(std::memory_order_relaxed)) {
-            // Join the previous search thread if it is still running
-            if (searchThread.joinable()) {
-                searchThread.join();
-            }
-            queryCopy = searchQuery;                           // Copy before clearing
-            isSearching.store(true, std::memory_order_relaxed);// Mark search as active
-            searchThread = std::thread([&]() {
-                searchMovies(api, queryCopy, movies, moviesMutex, isSearching);
-            });
-
-            if (!searchThread.joinable()) {
-            } else {
-            }
+        gui->waitForEvents();// Sleep until there is something to draw
+        // Check if searchQuery is updated
+        if (!searchQuery.empty()) {
+            queryCopy = searchQuery;// Copy before clearing
+            search = startSearch(api, scheduler, queryCopy, resultFeed, search, catalog.isOpen() ? &catalog : nullptr);
 
-            searchQuery.clear();// Reset after starting the thread
+            searchQuery.clear();// Reset after starting the search
+        }
+        // Fetch the next page once the user scrolls close to the end of the results
+        if (search) {
+            search->ensureRows(resultFeed.visibleRows());
         }
 
 
         // Render GUI
-        gui.render(searchQuery, movies, moviesMutex, isSearching, queryCopy, API_KEY);
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));// Prevent excessive CPU usage
+        gui->render(searchQuery, movies, moviesMutex, resultFeed, queryCopy, API_KEY);
     }
 
     // Cleanup before exit
-    if (searchThread.joinable()) {
-        searchThread.join();
+    if (search) {
+        search->cancel();
     }
+    // Stop the workers before the API and the texture loader their tasks use go away
+    scheduler.shutdown();
+    // Release ImGui and the poster textures before the GL context goes away
+    gui.reset();
     // Destroy window and terminate GLFW
     glfwDestroyWindow(window);
     glfwTerminate();
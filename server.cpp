@@ -0,0 +1,77 @@
+#include "LocalCatalog.h"
+#include "MovieServer.h"
+#include "OMDbApi.h"
+#include "TaskScheduler.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// API Key used when OMDB_API_KEY is not set (Replace with your real OMDb API key)
+const std::string DEFAULT_API_KEY = "133d7f7e";
+// Offline movie catalog, built with MoviesCatalog
+const std::string CATALOG_PATH = "catalog.idx";
+
+
+/**
+ * @brief Entry point of the headless lookup service.
+ *
+ * Serves search, details and poster lookups over HTTP (see MovieServer) from
+ * one set of caches, so every client on the host benefits from the others'
+ * requests. No window or GL context is created.
+ *
+ * Options:
+ * - "--host <address>": address to listen on (127.0.0.1 by default, local clients only);
+ * - "--port <port>": TCP port (8080 by default);
+ * - "--threads <count>": requests handled at the same time (32 by default);
+ * - "--rate <requests>": OMDb requests per second (10 by default);
+ * - "--daily-budget <requests>": OMDb requests per day, 0 for no limit (1000 by default).
+ *
+ * The OMDb API key is read from the OMDB_API_KEY environment variable.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments.
+ * @return int Returns 0 after the server stops, or -1 if it could not start.
+ */
+int main(int argc, char **argv) {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    size_t threadCount = 32;
+    RequestLimiter::Config limits;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            host = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            limits.perSecond = std::strtod(argv[++i], nullptr);
+            limits.burst = limits.perSecond;
+        } else if (std::strcmp(argv[i], "--daily-budget") == 0 && i + 1 < argc) {
+            limits.perDay = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--host <address>] [--port <port>] [--threads <count>]"
+                      << " [--rate <requests per second>] [--daily-budget <requests>]" << std::endl;
+            return -1;
+        }
+    }
+    if (port <= 0 || port > 65535 || threadCount == 0) {
+        std::cerr << "ERROR: Invalid port or thread count" << std::endl;
+        return -1;
+    }
+    const char *apiKey = std::getenv("OMDB_API_KEY");
+
+    // Worker threads for the OMDb requests; the connection pools get one connection per worker
+    TaskScheduler scheduler;
+    limits.maxConcurrency = scheduler.workerCount();
+    OMDbApi api(apiKey ? apiKey : DEFAULT_API_KEY, scheduler, "omdb_cache.bin", limits);
+    // Searches are answered offline when the catalog has been built
+    LocalCatalog catalog;
+    catalog.open(CATALOG_PATH);
+
+    MovieServer server(api, catalog.isOpen() ? &catalog : nullptr, threadCount);
+    bool served = server.listen(host, port);
+    scheduler.shutdown();
+    return served ? 0 : -1;
+}